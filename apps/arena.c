@@ -0,0 +1,180 @@
+//
+// Arena (slab) allocator for tree nodes
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 8   // every allocation is aligned to 8 bytes (pointers in nodes)
+
+/**
+ * Initialize an empty arena, no memory is allocated until the first arena_alloc
+ * @param arena arena to initialize
+ * @param slab_size size of the first slab
+ */
+void arena_init(struct arena *arena, size_t slab_size)
+{
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->used = 0;
+    arena->slab_size = slab_size;
+    arena->free_list = NULL;
+    arena->free_size = 0;
+}
+
+/**
+ * Allocate a new slab of at least size bytes
+ * @param arena arena owning the slab
+ * @param size minimum usable size of the slab
+ * @return new slab
+ */
+static struct arena_slab* arena_new_slab(struct arena *arena, size_t size)
+{
+    size_t slab_size = arena->slab_size;
+    while (slab_size < size)
+        slab_size *= 2;
+
+    struct arena_slab *slab;
+    slab = (struct arena_slab *) malloc(sizeof(struct arena_slab) + slab_size);
+    if (slab == NULL)
+    {
+        fprintf (stderr, "create arena slab fail\n");
+        exit(1);
+    }
+    slab->next = NULL;
+    slab->size = slab_size;
+
+    // next slab will be bigger, so big trees need few malloc calls
+    if (arena->slab_size < ARENA_MAX_SLAB_SIZE)
+        arena->slab_size *= 2;
+
+    return slab;
+}
+
+/**
+ * Get size bytes from the arena
+ * Memory comes from the current slab, when it is full the next slab of the
+ * chain is reused (after an arena_clear) or a new one is appended.
+ * @param arena arena to allocate from
+ * @param size number of bytes
+ * @return pointer to allocated memory
+ */
+void *arena_alloc(struct arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+
+    // reuse a released block of the same size
+    if (arena->free_list != NULL && size == arena->free_size)
+    {
+        void *ptr = arena->free_list;
+        arena->free_list = *(void **) ptr;
+        return ptr;
+    }
+
+    if (arena->current == NULL)
+    {
+        // first allocation of the arena
+        arena->first = arena_new_slab(arena, size);
+        arena->current = arena->first;
+        arena->used = 0;
+    }
+    else if (arena->used + size > arena->current->size)
+    {
+        // current slab is full: reuse next one if big enough, else insert a new slab
+        struct arena_slab *next = arena->current->next;
+        if (next == NULL || next->size < size)
+        {
+            struct arena_slab *slab = arena_new_slab(arena, size);
+            slab->next = next;
+            arena->current->next = slab;
+            next = slab;
+        }
+        arena->current = next;
+        arena->used = 0;
+    }
+
+    void *ptr = arena->current->mem + arena->used;
+    arena->used += size;
+    return ptr;
+}
+
+/**
+ * Copy a string inside the arena
+ * @param arena arena to allocate from
+ * @param s string to copy
+ * @return copy of the string
+ */
+char *arena_strdup(struct arena *arena, const char *s)
+{
+    size_t length = strlen(s) + 1;
+    char *copy = (char *) arena_alloc(arena, length);
+    memcpy(copy, s, length);
+    return copy;
+}
+
+/**
+ * Give back a single block to the arena, e.g. a deleted tree node
+ * Only blocks of one size (the size of the first released block, that is
+ * the size of the tree nodes) are recycled, other blocks stay in use until
+ * the arena is cleared.
+ * @param arena arena the block comes from
+ * @param ptr block to release
+ * @param size size of the block
+ */
+void arena_release(struct arena *arena, void *ptr, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+    if (arena->free_size == 0)
+        arena->free_size = size;
+    if (size != arena->free_size)
+        return;
+
+    // push the block on the free list, the link is stored in the block itself
+    *(void **) ptr = arena->free_list;
+    arena->free_list = ptr;
+}
+
+/**
+ * Release everything allocated from the arena in O(1)
+ * Slabs are kept and reused by next allocations.
+ * @param arena arena to clear
+ */
+void arena_clear(struct arena *arena)
+{
+    arena->current = arena->first;
+    arena->used = 0;
+    arena->free_list = NULL;
+}
+
+/**
+ * Give back every slab of the arena to the system
+ * @param arena arena to free
+ */
+void arena_free(struct arena *arena)
+{
+    struct arena_slab *slab = arena->first;
+    while (slab != NULL)
+    {
+        struct arena_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->used = 0;
+    arena->free_list = NULL;
+}
+
+/**
+ * Get number of bytes reserved by the arena
+ * @param arena arena to measure
+ * @return sum of slab sizes
+ */
+size_t arena_size(struct arena *arena)
+{
+    size_t size = 0;
+    for (struct arena_slab *slab = arena->first; slab != NULL; slab = slab->next)
+        size += slab->size;
+    return size;
+}
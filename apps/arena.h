@@ -0,0 +1,45 @@
+//
+// Arena (slab) allocator for tree nodes
+//
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_SLAB_SIZE     65536       // size of the first slab of an arena
+#define ARENA_MAX_SLAB_SIZE 67108864    // slabs double in size up to this limit
+
+/**
+ * Structure to represent each
+ * contiguous block of memory owned by an arena
+ */
+struct arena_slab
+{
+    struct arena_slab *next;
+    size_t size;
+    char mem[];
+};
+
+/**
+ * Structure to represent an arena:
+ * a chain of slabs filled from the first to the last one
+ */
+struct arena
+{
+    struct arena_slab *first;   // first slab of the chain
+    struct arena_slab *current; // slab in use
+    size_t used;                // bytes used in current slab
+    size_t slab_size;           // size of the next slab to allocate
+    void *free_list;            // released blocks, reused by next allocations
+    size_t free_size;           // size of the blocks in free_list
+};
+
+void arena_init(struct arena *arena, size_t slab_size);
+void *arena_alloc(struct arena *arena, size_t size);
+char *arena_strdup(struct arena *arena, const char *s);
+void arena_release(struct arena *arena, void *ptr, size_t size);
+void arena_clear(struct arena *arena);
+void arena_free(struct arena *arena);
+size_t arena_size(struct arena *arena);
+
+#endif //ARENA_H
@@ -0,0 +1,846 @@
+//
+// AVL tree (height balanced binary search tree)
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "trees.h"
+
+/**
+ * Get the height of the node
+ * @param avl_node AVL node
+ * @return height of the node
+ */
+static int height(struct avl_node* node)
+{
+    if (node == NULL)
+        return 0;
+    return node->height;
+}
+
+#ifdef SUBTREE_SIZE
+/**
+ * Get the number of nodes of the subtree rooted at node
+ * @param node AVL node
+ * @return subtree size
+ */
+static int size(struct avl_node* node)
+{
+    if (node == NULL)
+        return 0;
+    return node->size;
+}
+#endif
+
+/**
+ * Update the subtree size of a node from its children, if sizes are kept
+ * @param node AVL node
+ */
+static void update_size(struct avl_node* node)
+{
+#ifdef SUBTREE_SIZE
+    node->size = size(node->left) + size(node->right) + 1;
+#else
+    (void) node;
+#endif
+}
+
+/**
+ * Get maximum of two integers
+ * @param a int first integer
+ * @param b int second integer
+ * @return max of two values
+ */
+static int max(int a, int b)
+{
+    return (a > b)? a : b;
+}
+
+/**
+ * Right rotate AVL subtree rooted with y
+ * @param root avl_node AVL root
+ * @return rotated AVL
+ */
+struct avl_node* avl_right_rotate(struct avl_node* root)
+{
+    struct avl_node* x = root->left;
+    struct avl_node* T2 = x->right;
+
+    // Perform rotation
+    x->right = root;
+    root->left = T2;
+
+    // Update heights
+    root->height = max(height(root->left), height(root->right))+1;
+    x->height = max(height(x->left), height(x->right))+1;
+
+    // Update sizes
+    update_size(root);
+    update_size(x);
+
+    // Return new root
+    return x;
+}
+
+/**
+ * Left rotate AVL subtree rooted with y
+ * @param root avl_node AVL root
+ * @return rotated AVL
+ */
+struct avl_node *avl_left_rotate(struct avl_node* root)
+{
+    struct avl_node *y = root->right;
+    struct avl_node *T2 = y->left;
+
+    // Perform rotation
+    y->left = root;
+    root->right = T2;
+
+    //  Update heights
+    root->height = max(height(root->left), height(root->right))+1;
+    y->height = max(height(y->left), height(y->right))+1;
+
+    // Update sizes
+    update_size(root);
+    update_size(y);
+
+    // Return new root
+    return y;
+}
+
+/**
+ * Get balance factor of node N
+ * @param node avl_node
+ * @return balance factor
+ */
+static int getBalance(struct avl_node* node)
+{
+    if (node == NULL)
+        return 0;
+    return height(node->left) - height(node->right);
+}
+
+/**
+ * Create a new avl_node
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param key node key
+ * @param data node value
+ * @return new avl node
+ */
+struct avl_node* avl_create(struct arena *arena, int key, char *data)
+{
+    struct avl_node *new_node;
+    if (arena != NULL)
+        new_node = (struct avl_node *) arena_alloc(arena, sizeof(avl_node));
+    else
+        new_node = (struct avl_node *) malloc(sizeof(avl_node));
+    if (new_node == NULL)
+    {
+        fprintf (stderr, "create avl node fail\n");
+        exit(1);
+    }
+    new_node->key = key;
+    payload_set(&new_node->data, arena, data);
+    new_node->left = NULL;
+    new_node->right = NULL;
+    new_node->height = 1;
+#ifdef SUBTREE_SIZE
+    new_node->size = 1;
+#endif
+
+    return new_node;
+}
+
+/**
+ * Insert new node in an AVL
+ * Walk down saving the links followed, then walk the path back
+ * updating heights and rebalancing, until a subtree keeps its height.
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param avl_node AVL root
+ * @param key key to insert
+ * @param data value to insert
+ * @return AVL with new node
+ */
+struct avl_node* avl_insert(struct arena *arena, struct avl_node *node, int key, char *data) {
+    struct avl_node **path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    struct avl_node **link = &node;
+
+    // Traverse to the right place and insert the node
+    while (*link != NULL) {
+        if (key == (*link)->key) // Equal keys are not allowed in AVL
+            return node;
+        path[depth++] = link;
+        if (key < (*link)->key)
+            link = &(*link)->left;
+        else
+            link = &(*link)->right;
+    }
+    *link = avl_create(arena, key, data);
+
+    while (depth > 0) {
+        link = path[--depth];
+        struct avl_node *parent = *link;
+        int old_height = parent->height;
+
+        /* Update height and size of this node */
+        parent->height = 1 + max(height(parent->left), height(parent->right));
+        update_size(parent);
+
+        // Get the balance factor of this node
+        // to check whether this node became unbalanced
+        int balance = getBalance(parent);
+
+        // If this node becomes unbalanced, then
+        // there are 4 cases
+
+        // Left Left Case
+        if (balance > 1 && key < parent->left->key)
+            *link = avl_right_rotate(parent);
+
+        // Right Right Case
+        else if (balance < -1 && key > parent->right->key)
+            *link = avl_left_rotate(parent);
+
+        // Left Right Case
+        else if (balance > 1 && key > parent->left->key)
+        {
+            parent->left =  avl_left_rotate(parent->left);
+            *link = avl_right_rotate(parent);
+        }
+
+        // Right Left Case
+        else if (balance < -1 && key < parent->right->key)
+        {
+            parent->right = avl_right_rotate(parent->right);
+            *link = avl_left_rotate(parent);
+        }
+
+        // Subtree height unchanged: nodes above are still balanced
+        if ((*link)->height == old_height)
+            break;
+    }
+    // nodes above only change size
+    while (depth > 0)
+        update_size(*path[--depth]);
+
+    /* return the avl root */
+    return node;
+}
+
+/**
+ * Search a node with key and, if found, return its value
+ * @param node AVL to search for the key
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* avl_find(struct avl_node* node, int key) {
+    while (node != NULL) {
+        if (node->key == key)
+            return payload_get(&node->data);
+        if (node->key < key)
+            node = node->right;
+        else
+            node = node->left;
+    }
+    return NULL;
+}
+
+/**
+ * Free a single AVL node and its data
+ * @param arena arena the node comes from, NULL if allocated with malloc
+ * @param node node to free
+ */
+static void avl_destroy(struct arena *arena, struct avl_node *node)
+{
+    if (arena != NULL) {
+        arena_release(arena, node, sizeof(avl_node));
+    } else {
+        payload_free(&node->data);
+        free(node);
+    }
+}
+
+/**
+ * Walk back a path of links after the subtree under it lost or gained height
+ * Heights and sizes are updated and nodes rebalanced, until a subtree keeps
+ * its height: the nodes above only change size.
+ * @param path links followed from the root, the first one is the root link
+ * @param depth number of links
+ */
+static void rebalance(struct avl_node **path[], int depth)
+{
+    struct avl_node **link;
+
+    while (depth > 0) {
+        link = path[--depth];
+        struct avl_node *parent = *link;
+        int old_height = parent->height;
+
+        /* Update height and size of this node */
+        parent->height = 1 + max(height(parent->left), height(parent->right));
+        update_size(parent);
+
+        // Get the balance factor of this node
+        // to check whether this node became unbalanced
+        int balance = getBalance(parent);
+
+        // Left Left and Left Right Cases
+        if (balance > 1)
+        {
+            if (getBalance(parent->left) < 0)
+                parent->left = avl_left_rotate(parent->left);
+            *link = avl_right_rotate(parent);
+        }
+
+        // Right Right and Right Left Cases
+        else if (balance < -1)
+        {
+            if (getBalance(parent->right) > 0)
+                parent->right = avl_right_rotate(parent->right);
+            *link = avl_left_rotate(parent);
+        }
+
+        // Subtree height unchanged: nodes above are still balanced
+        if ((*link)->height == old_height)
+            break;
+    }
+    // nodes above only change size
+    while (depth > 0)
+        update_size(*path[--depth]);
+}
+
+/**
+ * Delete the node with key from an AVL
+ * A node with two children takes key and data of its successor
+ * (leftmost node of right subtree), which is unlinked in its place.
+ * Then the path is walked back updating heights and rebalancing,
+ * until a subtree keeps its height.
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node AVL root
+ * @param key key to delete
+ * @return AVL without the key
+ */
+struct avl_node* avl_delete(struct arena *arena, struct avl_node *node, int key) {
+    struct avl_node **path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    struct avl_node **link = &node;
+
+    // Traverse to the node to delete
+    while (*link != NULL && (*link)->key != key) {
+        path[depth++] = link;
+        if (key < (*link)->key)
+            link = &(*link)->left;
+        else
+            link = &(*link)->right;
+    }
+    if (*link == NULL)
+        return node;
+
+    struct avl_node *target = *link;
+    if (target->left != NULL && target->right != NULL) {
+        // find the successor, swap it with target and delete it instead
+        path[depth++] = link;
+        link = &target->right;
+        while ((*link)->left != NULL) {
+            path[depth++] = link;
+            link = &(*link)->left;
+        }
+        struct avl_node *successor = *link;
+        struct payload data = target->data;
+        target->key = successor->key;
+        target->data = successor->data;
+        successor->data = data;
+        target = successor;
+    }
+
+    // target has at most one child: link it in place of target
+    *link = (target->left != NULL) ? target->left : target->right;
+    avl_destroy(arena, target);
+
+    rebalance(path, depth);
+
+    /* return the avl root */
+    return node;
+}
+
+/**
+ * Free all nodes allocated with malloc
+ * Given an AVL binary tree, rotate the left child up until the node has none,
+ * then free the node and go on with its right child:
+ * no recursion and no extra memory, whatever the tree shape.
+ * @param node
+ */
+void avl_free_nodes(struct avl_node* node) {
+    while (node != NULL) {
+        if (node->left != NULL) {
+            // right rotation: left child becomes the subtree root
+            struct avl_node *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            // no left subtree: deal with the node, then go right
+            struct avl_node *right = node->right;
+            payload_free(&node->data);
+            free(node);
+            node = right;
+        }
+    }
+}
+
+/**
+ * Remove all nodes from AVL
+ * Nodes taken from an arena are released at once in O(1)
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node AVL root
+ */
+void avl_clear(struct arena *arena, struct avl_node* node) {
+    if (arena != NULL)
+        arena_clear(arena);
+    else
+        avl_free_nodes(node);
+}
+
+/**
+ * Print key and data of a node of an AVL
+ * @param node node to print
+ */
+static void avl_show_node(struct avl_node* node)
+{
+    output_int(node->key);
+    output_char(':');
+    output_string(payload_get(&node->data));
+    output_char(':');
+    output_int(node->height);
+    output_char(' ');
+}
+
+/**
+ * Show current AVL with prefix expression (Polish notation)
+ * Given an AVL binary tree, print its nodes in preorder (root, left, right).
+ * Morris traversal: the rightmost node of each left subtree is temporarily
+ * threaded to its successor, so no recursion nor stack is needed.
+ * A thread found again marks the end of a left subtree, whose last node
+ * has an empty right child.
+ * @param node avl to traverse
+ */
+void avl_show(struct avl_node* node)
+{
+    struct avl_node *pred;
+    while (node != NULL) {
+        if (node->left == NULL) {
+            /* print data of node and its empty left subtree, then go right */
+            avl_show_node(node);
+            output_string("NULL ");
+            node = node->right;
+            continue;
+        }
+
+        // find the rightmost node of left subtree
+        pred = node->left;
+        while (pred->right != NULL && pred->right != node)
+            pred = pred->right;
+
+        if (pred->right == NULL) {
+            /* first visit: print data of node, thread it and go left */
+            avl_show_node(node);
+            pred->right = node;
+            node = node->left;
+        } else {
+            /* left subtree done: remove the thread, print its empty right child and go right */
+            pred->right = NULL;
+            output_string("NULL ");
+            node = node->right;
+        }
+    }
+    /* empty right child of the last node (or empty tree) */
+    output_string("NULL ");
+}
+
+/**
+ * Collect the nodes of an AVL in order
+ * @param node AVL root
+ * @param nodes nodes in order, NULL to count only
+ * @return number of nodes
+ */
+int avl_in_order(struct avl_node* node, struct avl_node **nodes)
+{
+    struct avl_node *path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    int n = 0;
+
+    while (node != NULL || depth > 0) {
+        // go down to the leftmost node not visited
+        while (node != NULL) {
+            path[depth++] = node;
+            node = node->left;
+        }
+        node = path[--depth];
+        if (nodes != NULL)
+            nodes[n] = node;
+        n++;
+        node = node->right;
+    }
+    return n;
+}
+
+/**
+ * Link nodes in order into a complete AVL in O(n)
+ * Node i in order takes slot i in order of an implicit complete tree,
+ * the children of slot k are slots 2k and 2k + 1. Heights and sizes are set
+ * from the last slot up, children come after their parent.
+ * @param nodes nodes sorted by key, without equal keys
+ * @param n number of nodes
+ * @return AVL root
+ */
+struct avl_node* avl_build(struct avl_node **nodes, int n)
+{
+    if (n == 0)
+        return NULL;
+    struct avl_node **slots = (struct avl_node **) malloc((n + 1) * sizeof(struct avl_node *));
+    if (slots == NULL)
+    {
+        fprintf (stderr, "create avl slots fail\n");
+        exit(1);
+    }
+    int k = implicit_first(n);
+    for (int i = 0; i < n; i++) {
+        slots[k] = nodes[i];
+        k = implicit_next(k, n);
+    }
+    for (k = n; k >= 1; k--) {
+        slots[k]->left = (2 * k <= n) ? slots[2 * k] : NULL;
+        slots[k]->right = (2 * k + 1 <= n) ? slots[2 * k + 1] : NULL;
+        slots[k]->height = max(height(slots[k]->left), height(slots[k]->right))+1;
+        update_size(slots[k]);
+    }
+    struct avl_node *root = slots[1];
+    free(slots);
+    return root;
+}
+
+/**
+ * Add sorted pairs to an AVL in O(n)
+ * Nodes of the AVL and new nodes are merged in order, then linked again
+ * into a complete AVL. Equal keys are not allowed: a pair with a key
+ * already in the tree (or repeated) is skipped.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node AVL root
+ * @param pairs pairs sorted by key
+ * @return AVL with new nodes
+ */
+struct avl_node* avl_load(struct arena *arena, struct avl_node *node, const struct pairs *pairs)
+{
+    int old = avl_in_order(node, NULL);
+    struct avl_node **nodes = (struct avl_node **) malloc((old + pairs->count + 1) * sizeof(struct avl_node *));
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create avl slots fail\n");
+        exit(1);
+    }
+    // old nodes at the end, merged from the start: writes never reach unread nodes
+    avl_in_order(node, nodes + pairs->count);
+    int a = pairs->count;
+    int end = pairs->count + old;
+    int b = 0;
+    int n = 0;
+    while (a < end || b < pairs->count) {
+        if (b == pairs->count || (a < end && nodes[a]->key <= pairs->keys[b])) {
+            nodes[n++] = nodes[a++];
+        } else {
+            if (n == 0 || nodes[n - 1]->key != pairs->keys[b])
+                nodes[n++] = avl_create(arena, pairs->keys[b], pairs_data(pairs, b));
+            b++;
+        }
+    }
+    node = avl_build(nodes, n);
+    free(nodes);
+    return node;
+}
+
+/**
+ * Count the nodes of an AVL, stopping at limit
+ * @param node AVL root
+ * @param limit nodes to count at most
+ * @return number of nodes, limit if there are more
+ */
+static int avl_count(struct avl_node* node, int limit)
+{
+#ifdef SUBTREE_SIZE
+    return (size(node) < limit) ? size(node) : limit;
+#else
+    struct avl_node *path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    int n = 0;
+
+    while ((node != NULL || depth > 0) && n < limit) {
+        // go down to the leftmost node not counted
+        while (node != NULL) {
+            path[depth++] = node;
+            node = node->left;
+        }
+        node = path[--depth];
+        n++;
+        node = node->right;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Merge sorted pairs into an AVL through joins, in O(m log(n / m + 1))
+ * The root splits the pairs: smaller keys are merged into its left subtree,
+ * greater ones into its right subtree, then the root joins them again.
+ * Subtrees that get no pairs are not visited, pairs that reach an empty
+ * subtree are built into a balanced one around their middle pair. Equal keys
+ * are not allowed: a pair with a key already in the tree (or repeated) is skipped.
+ * Recursion is as deep as the tree.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node AVL root
+ * @param pairs pairs sorted by key
+ * @param low first pair to merge
+ * @param high end of the pairs to merge, excluded
+ * @return AVL with new nodes
+ */
+static struct avl_node* avl_merge(struct arena *arena, struct avl_node *node, const struct pairs *pairs,
+                                  int low, int high)
+{
+    if (low == high)
+        return node;
+    int less;
+    if (node == NULL) {
+        // first pair of the middle key
+        int middle = low + (high - low) / 2;
+        less = batch_lower_bound(pairs->keys, low, middle, pairs->keys[middle]);
+        node = avl_create(arena, pairs->keys[less], pairs_data(pairs, less));
+    } else {
+        less = batch_lower_bound(pairs->keys, low, high, node->key);
+    }
+    int greater = less;
+    while (greater < high && pairs->keys[greater] == node->key)
+        greater++;
+
+    struct avl_node *left = avl_merge(arena, node->left, pairs, low, less);
+    struct avl_node *right = avl_merge(arena, node->right, pairs, greater, high);
+    return avl_join(left, node, right);
+}
+
+/**
+ * Insert a batch of pairs in an AVL
+ * A big enough batch is sorted by key and merged with the tree by avl_merge,
+ * a smaller one is inserted in arrival order, as one by one.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node AVL root
+ * @param pairs pairs to insert, sorted in place when merged
+ * @return AVL with new nodes
+ */
+struct avl_node* avl_insert_batch(struct arena *arena, struct avl_node *node, struct pairs *pairs)
+{
+    int limit = batch_merge_limit(pairs->count);
+    if (limit > 0 && batch_merges(pairs->count, avl_count(node, limit))) {
+        pairs_sort(pairs);
+        return avl_merge(arena, node, pairs, 0, pairs->count);
+    }
+
+    for (int i = 0; i < pairs->count; i++)
+        node = avl_insert(arena, node, pairs->keys[i], pairs_data(pairs, i));
+    return node;
+}
+
+/**
+ * Move a cursor to the first node of an AVL whose key is not less than key
+ * Only the nodes on the path from the root are visited.
+ * @param it cursor
+ * @param root AVL root
+ * @param key lowest key to visit
+ */
+void avl_iter_seek(struct avl_iterator *it, struct avl_node *root, int key)
+{
+    it->depth = 0;
+    while (root != NULL) {
+        if (root->key >= key) {
+            // root comes after the nodes of its left subtree
+            it->stack[it->depth++] = root;
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+}
+
+/**
+ * Get the node of a cursor and move it to the next node in order
+ * @param it cursor
+ * @return current node, NULL after the last node
+ */
+struct avl_node* avl_iter_next(struct avl_iterator *it)
+{
+    if (it->depth == 0)
+        return NULL;
+    struct avl_node *node = it->stack[--it->depth];
+    // next nodes: leftmost path of the right subtree
+    for (struct avl_node *next = node->right; next != NULL; next = next->left)
+        it->stack[it->depth++] = next;
+    return node;
+}
+
+/**
+ * Get the rank of a key in an AVL: the number of keys less than key
+ * With subtree sizes it is O(log n), else the keys are counted in order.
+ * @param node AVL root
+ * @param key key to rank, it may be missing
+ * @return number of keys less than key
+ */
+int avl_rank(struct avl_node* node, int key)
+{
+    int rank = 0;
+#ifdef SUBTREE_SIZE
+    while (node != NULL) {
+        if (node->key < key) {
+            // node and its left subtree are less than key
+            rank += size(node->left) + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+#else
+    struct avl_iterator it;
+    avl_iter_seek(&it, node, INT_MIN);
+    while ((node = avl_iter_next(&it)) != NULL && node->key < key)
+        rank++;
+#endif
+    return rank;
+}
+
+/**
+ * Select the k-th smallest key of an AVL
+ * With subtree sizes it is O(log n), else the nodes are visited in order.
+ * @param node AVL root
+ * @param k position in order, from 1
+ * @return k-th node, NULL if k is not between 1 and the number of nodes
+ */
+struct avl_node* avl_select(struct avl_node* node, int k)
+{
+    if (k < 1)
+        return NULL;
+#ifdef SUBTREE_SIZE
+    while (node != NULL) {
+        int left = size(node->left);
+        if (k <= left) {
+            node = node->left;
+        } else if (k == left + 1) {
+            return node;
+        } else {
+            k -= left + 1;
+            node = node->right;
+        }
+    }
+    return NULL;
+#else
+    struct avl_iterator it;
+    avl_iter_seek(&it, node, INT_MIN);
+    while ((node = avl_iter_next(&it)) != NULL && k > 1)
+        k--;
+    return node;
+#endif
+}
+
+/**
+ * Join two AVLs with a node between them in O(|height difference| + 1)
+ * The node goes down the right spine of the taller left tree (left spine of
+ * the taller right tree) to a subtree at most one level taller than the
+ * other tree, takes its place with the other tree as a child, and the path
+ * is rebalanced.
+ * @param left AVL whose keys are less than the key of node
+ * @param node node to link, its children are overwritten
+ * @param right AVL whose keys are greater than the key of node
+ * @return AVL with the nodes of left, node and right
+ */
+struct avl_node* avl_join(struct avl_node *left, struct avl_node *node, struct avl_node *right)
+{
+    struct avl_node **path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    struct avl_node *root = node;
+    struct avl_node **link = &root;
+
+    if (height(left) > height(right) + 1) {
+        root = left;
+        while (height(*link) > height(right) + 1) {
+            path[depth++] = link;
+            link = &(*link)->right;
+        }
+        left = *link;
+    } else if (height(right) > height(left) + 1) {
+        root = right;
+        while (height(*link) > height(left) + 1) {
+            path[depth++] = link;
+            link = &(*link)->left;
+        }
+        right = *link;
+    }
+    node->left = left;
+    node->right = right;
+    node->height = max(height(left), height(right))+1;
+    update_size(node);
+    *link = node;
+
+    rebalance(path, depth);
+    return root;
+}
+
+/**
+ * Split an AVL at a key in O(log n)
+ * Nodes on the path of key are joined, from the bottom up, with their
+ * subtree on the other side of the path into the tree of their side.
+ * @param node AVL root, its nodes are moved to the two trees
+ * @param key first key of the greater tree
+ * @param less AVL with the keys less than key
+ * @param greater AVL with the keys not less than key
+ */
+void avl_split(struct avl_node *node, int key, struct avl_node **less, struct avl_node **greater)
+{
+    struct avl_node *path[AVL_MAX_HEIGHT];
+    int depth = 0;
+
+    while (node != NULL) {
+        path[depth++] = node;
+        node = (node->key < key) ? node->right : node->left;
+    }
+    *less = NULL;
+    *greater = NULL;
+    while (depth > 0) {
+        node = path[--depth];
+        if (node->key < key)
+            *less = avl_join(node->left, node, *less);
+        else
+            *greater = avl_join(*greater, node, node->right);
+    }
+}
+
+/**
+ * Concatenate two AVLs in O(log n)
+ * The leftmost node of right is unlinked, then it joins the two trees.
+ * @param left AVL whose keys are less than the keys of right
+ * @param right AVL
+ * @return AVL with the nodes of left and right
+ */
+struct avl_node* avl_concat(struct avl_node *left, struct avl_node *right)
+{
+    struct avl_node **path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    struct avl_node **link = &right;
+
+    if (right == NULL)
+        return left;
+    while ((*link)->left != NULL) {
+        path[depth++] = link;
+        link = &(*link)->left;
+    }
+    struct avl_node *first = *link;
+    *link = first->right;
+    rebalance(path, depth);
+    return avl_join(left, first, right);
+}
@@ -1,31 +1,145 @@
+#define _GNU_SOURCE     // sched_setaffinity, to pin chart jobs to cores
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <limits.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <getopt.h>
+#include <stdarg.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "trees.h"
+#include "index_trees.h"
+#include "frozen_trees.h"
+#include "shard_map.h"
+#include "cow_tree.h"
+#include "rw_tree.h"
+#include "perf_counters.h"
+#include "key_workload.h"
+#include "prng.h"
+
+// defaults of the command line options
+#define MIN_N_LENGTH           1000      // minimum number of operations (--min-n)
+#define MAX_N_LENGTH           1000000   // maximum number of operations (--max-n)
+#define CHART_DATA_POINTS      100       // number of points to plot on chart (--points)
+#define ERROR_MAX              0.01      // maximum relative error (--error)
+#define MIN_TIMES              10        // minimum number of iterations (--min-times)
+#define MAX_TIMES              10000     // maximum number of iterations (--max-times)
+#define USE_MEDIAN             0         // Use mean/standard deviation or median/median absolute deviation as output data (--statistic)
+#define CHART_MAX_COLUMNS      96        // columns of a chart line after the number of operations, at most
+#define WARM_UP_RUNS           2         // untimed runs of a workload before its measures
+
+#ifdef CLOCK_MONOTONIC_RAW
+#define MEASURE_CLOCK CLOCK_MONOTONIC_RAW   // clock of all measures
+#else
+#define MEASURE_CLOCK CLOCK_MONOTONIC
+#endif
+#define BST_SORTED_MAX_N       10000     // BST sorted insert is quadratic, not measured on bigger trees
+#define BATCH_TREE_SIZE        100000    // keys in the trees batches are inserted in
+#define BATCH_KEYS             131072    // keys inserted in each batch measure
+#define RANGE_TREE_SIZE        100000    // keys in the trees range scans run on
+#define RANGE_MIN_SELECTIVITY  20        // narrowest range scan covers 2^-20 of the keys space
+#define RANGE_MAX_SCANS        10000     // range scans in each measure, at most
+#define SPLIT_CUTS             16        // cuts of a tree in each split measure
+#define SPLIT_REBUILD_MAX_N    100000    // cuts by rebuilding are linear, not measured on bigger trees
+#define SHARD_COUNT            64        // shards of the maps of the threads measure
+#define SHARD_KEYS             1000000   // keys searched and inserted by all threads together
+#define SHARD_RUNS             5         // measures of each number of threads
+#define READS_TREE_SIZE        100000    // keys in the trees of the reads measure before inserts start
+#define READS_KEYS             1000000   // keys searched by all reader threads together
+#define RW_TREE_SIZE           100000    // keys in the trees of the rwlock measure before writers start
+#define RW_OPS                 200000    // finds of each reader thread, inserts of each writer thread
+#define RW_READERS             4         // reader threads of the rwlock measure, unless given after "rwlock"
+#define RW_WRITERS             1         // writer threads of the rwlock measure, unless given after "rwlock"
+
+/* Statistics of every measure */
+enum statistic {
+    MEAN,       // average and standard deviation
+    MEDIAN,     // median and median absolute deviation
+    STATISTICS  // number of statistics
+};
+
+/* Format of the chart lines */
+enum outputFormat {
+    TEXT,   // columns separated by spaces, comment lines start with #, read by gnuplot
+    CSV     // columns separated by commas, no comment lines
+};
+
+/* Trees of the chart, bits of options.trees */
+enum chartTree {
+    CHART_BST = 1,
+    CHART_AVL = 2,
+    CHART_RBT = 4,
+    CHART_BTREE = 8,
+    CHART_ALL_TREES = 15
+};
 
-#define MIN_N_LENGTH           1000      // minimum number of operations
-#define MAX_N_LENGTH           1000000   // maximum number of operations
-#define CHART_DATA_POINTS      100       // number of points to plot on chart
-#define ERROR_MAX              0.01      // maximum relative error
-#define MIN_TIMES              10        // minimum number of iterations
-#define MAX_TIMES              10000     // maximum number of iterations
-#define MAX_CMD_LENGTH         15        // maximum length of a command name
-#define USE_MEDIAN             0         // Use mean/standard deviation or median/median absolute deviation as output data
+/* Options of a run, set from the command line */
+struct options {
+    int min_n;                  // minimum number of operations
+    int max_n;                  // maximum number of operations
+    int points;                 // number of points to plot on chart
+    double error_max;           // maximum relative error
+    int min_times;              // minimum number of iterations
+    int max_times;              // maximum number of iterations
+    enum statistic statistic;   // statistic of standard output and of the tables
+    unsigned int trees;         // trees measured on the chart, chartTree bits
+    enum outputFormat format;
+    unsigned long long seed;    // seed of the keys, the time by default
+    struct key_workload keys;   // keys of every benchmark, uniform by default
+};
 
 /* Global variables */
 double b;
 long resolution;
+struct options options = {
+    .min_n = MIN_N_LENGTH, .max_n = MAX_N_LENGTH, .points = CHART_DATA_POINTS,
+    .error_max = ERROR_MAX, .min_times = MIN_TIMES, .max_times = MAX_TIMES,
+    .statistic = USE_MEDIAN ? MEDIAN : MEAN, .trees = CHART_ALL_TREES, .format = TEXT
+};
+struct perf_counters perf;  // hardware counters of the measures, when the perf argument is given
+
+/* Workloads to measure */
+enum workload {
+    SEARCH_AND_INSERT,  // search n keys of the workload, insert the missing ones
+    INSERT_AND_DELETE,  // insert n keys of the workload, then delete all of them
+    SORTED_INSERT,      // insert n sorted keys one by one
+    SORTED_LOAD         // bulk load n sorted keys
+};
 
-/* Data point record */
+/* Workload runner of a tree, it returns the tree root to clear later */
+typedef void* (*workload_fn)(const int *keys, int n, struct arena *arena);
+
+/* Tree to measure */
+struct tree_bench {
+    workload_fn search_and_insert;               // search n keys, insert the missing ones
+    workload_fn insert_and_delete;               // insert n keys, then delete all of them
+    void (*clear)(struct arena *arena, void *root); // remove all nodes of the tree
+    workload_fn sorted_insert;                   // insert n sorted keys one by one
+    workload_fn sorted_load;                     // bulk load n sorted keys
+};
+
+/* Data point record, every measure holds each statistic */
 struct Records {
-    int n;     // Number of search-and-insert iterations
-    double t1; //
-    double t2; // Average or Median amortized time
-    double t3; //
-    double d1; //
-    double d2; // Standard Deviation or Median Absolute Deviation
-    double d3; //
+    int n;                   // Number of search-and-insert iterations
+    double t1[STATISTICS];   //
+    double t2[STATISTICS];   // Average and Median amortized time
+    double t3[STATISTICS];   //
+    double t4[STATISTICS];   //
+    double d1[STATISTICS];   //
+    double d2[STATISTICS];   // Standard Deviation and Median Absolute Deviation
+    double d3[STATISTICS];   //
+    double d4[STATISTICS];   //
+};
+
+/* Hardware counters per operation of BST, AVL, RBT and B-tree for a data point, NAN if unavailable */
+struct Counters {
+    double c[4][PERF_COUNTERS];
 };
 
 /*********************************
@@ -101,16 +215,38 @@ void quickSort(double arr[], int low, int high)
  *************************/
 
 /**
- * Get system clock resolution
+ * Get time of the clock of the measures
+ * CLOCK_MONOTONIC_RAW is not slewed by NTP, so measures are not stretched
+ * or shrunk while the system clock is adjusted.
+ * @return nano seconds from an arbitrary point
+ */
+long long clock_ns() {
+    struct timespec now;
+    clock_gettime(MEASURE_CLOCK, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Get CPU time of the process, that is of every thread of the process
+ * @return nano seconds of CPU time
+ */
+long long cpu_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Get resolution of the clock of the measures: the smallest step between two reads
  * @return clock resolution in nano seconds
  */
 long getResolution() {
-    struct timespec start, end;
-    clock_gettime(CLOCK_MONOTONIC, &start);
+    long long start, end;
+    start = clock_ns();
     do {
-        clock_gettime(CLOCK_MONOTONIC, &end);
-    } while(start.tv_nsec == end.tv_nsec);
-    return (end.tv_nsec - start.tv_nsec);
+        end = clock_ns();
+    } while (start == end);
+    return (long) (end - start);
 }
 
 /**
@@ -120,10 +256,24 @@ long getResolution() {
  */
 int get_iterations_number(ssize_t dp) {
     int length;
-    length = MIN_N_LENGTH * (pow (b, (double) dp));
+    length = options.min_n * (pow (b, (double) dp));
     return length;
 }
 
+/**
+ * Allocate an array of times, one for each iteration
+ * @return array of options.max_times times
+ */
+double* times_alloc() {
+    double *times = (double *) malloc(options.max_times * sizeof(double));
+    if (times == NULL)
+    {
+        fprintf (stderr, "create times array fail\n");
+        exit(1);
+    }
+    return times;
+}
+
 /**
  * Get median value of array
  * @param arr array to elaborate
@@ -154,148 +304,88 @@ double get_mad(double arr[], int n, double median) {
 
 
 /***********************************
- *  BST
+ *  Keys
  ************************************/
 
-/**
- * Structure to represent each
- * node in a binary search tree
- */
-typedef struct bst_node
-{
-    int key;
-    char *data;
-    struct bst_node *left;
-    struct bst_node *right;
-} bst_node;
+/* Keys of the sorted insert and sorted load workloads, whatever the workload option */
+struct key_workload sorted_keys = { .distribution = KEYS_SEQUENTIAL };
+
+/* Generator of the keys of the measures, drawn from the seed option */
+struct prng keys_prng;
 
 /**
- * Create a new BST node
- * @param key node key
- * @param data node value
- * @return new BST node
+ * Allocate an array of keys
+ * @param n number of keys
+ * @return keys array, to free
  */
-struct bst_node* bst_create(int key, char *data)
-{
-    struct bst_node *new_node;
-    new_node = (struct bst_node *) malloc(sizeof(bst_node));
-    if (new_node == NULL)
+int* keys_alloc(int n) {
+    int *keys = (int *) malloc(n * sizeof(int));
+    if (keys == NULL)
     {
-        fprintf (stderr, "create bst node fail\n");
+        fprintf (stderr, "create keys array fail\n");
         exit(1);
     }
-    new_node->key = key;
-    new_node->data = strdup(data);
-    new_node->left = NULL;
-    new_node->right = NULL;
-
-    return new_node;
+    return keys;
 }
 
 /**
- * Insert new node in a BST
- * @param node root BST
- * @param key key to insert
- * @param data value to insert
- * @return BST with new node
+ * Draw n keys of the workload option, ahead of a measure
+ * @param n number of keys
+ * @return keys array, to free
  */
-struct bst_node* bst_insert(struct bst_node *node, int key, char *data) {
-    // Return a new node if the tree is empty
-    if (node == NULL)
-    {
-        return bst_create(key, data);
-    }
-
-    // Traverse to the right place and insert the node
-    if (key < node->key) {
-        node->left = bst_insert(node->left, key, data);
-    } else {
-        node->right = bst_insert(node->right, key, data);
-    }
-    return node;
-}
-
-/**
- * Search a node with key and, if found, return its value
- * @param node BST to search for the key
- * @param key key to search
- * @return node data if key exist
- */
-const char* bst_find(struct bst_node* node, int key) {
-    if (node->key == key)
-        return node->data;
-    if (node->key < key) {
-        if (node->right != NULL)
-            return bst_find(node->right, key);
-    } else {
-        if (node->left != NULL)
-            return bst_find(node->left, key);
-    }
-    return strdup("");
+int* workload_keys(int n) {
+    int *keys = keys_alloc(n);
+    key_workload_fill(&options.keys, &keys_prng, keys, n);
+    return keys;
 }
 
 /**
- * Remove all nodes from BST
- * Given a BST, remove its nodes in postorder (left, right, root)
- * @param node
+ * Draw n keys of the workload option from a stream of their own, e.g. the keys of a thread
+ * The stream is split from the keys generator, streams of threads never overlap.
+ * @param keys keys to fill
+ * @param n number of keys
  */
-void bst_clear(struct bst_node* node) {
-    if (node == NULL)
-        return;
-
-    // first recur on left subtree
-    bst_clear(node->left);
-
-    // then recur on right subtree
-    bst_clear(node->right);
-
-    // now deal with the node
-    free(node);
-    node = NULL;
+void stream_keys(int *keys, int n) {
+    struct prng stream;
+    prng_split(&keys_prng, &stream);
+    key_workload_fill(&options.keys, &stream, keys, n);
 }
 
 /**
- * Show current bst with prefix expression (Polish notation)
- * Given a BST, print its nodes in preorder (root, left, right)
- * @param node bst to traverse
+ * Fill a list with n sorted keys
+ * @param pairs list of pairs to fill
+ * @param keys sorted keys
+ * @param n number of keys
  */
-void bst_show(struct bst_node* node)
-{
-    if (node == NULL) {
-        printf("NULL ");
-        return;
+void sorted_pairs(struct pairs *pairs, const int *keys, int n) {
+    pairs_init(pairs);
+    for (int i=0; i < n; i++) {
+        pairs_add(pairs, keys[i], "d");
     }
+}
 
-    /* first print data of node */
-    printf("%d:%s ", node->key, node->data);
-
-    /* then recur on left subtree */
-    bst_show(node->left);
 
-    /* now recur on right subtree */
-    bst_show(node->right);
-}
+/***********************************
+ *  BST
+ ************************************/
 
 /**
  * Search and insert n keys in an Binary Search Tree
+ * @param keys keys of the workload, drawn ahead of the measure
  * @param n number of keys to search and insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
  * @return BST root node
  */
-struct bst_node* bst_search_and_insert(int n) {
+void* bst_search_and_insert(const int *keys, int n, struct arena *arena) {
     struct bst_node* root = NULL;
-    char result[2] = "";
     int hit = 0;
     int miss = 0;
 
     for (int i=0; i < n; i++) {
-        // In the GNU C Library the largest value the rand function can return is 2147483647.
-        int randomNumber;
-        randomNumber = rand();
-        if (root != NULL)
-            strcpy(result, bst_find(root, randomNumber));
-        if ((strcmp(result, "d") != 0)) {
+        int key = keys[i];
+        if (root == NULL || bst_find(root, key) == NULL) {
             miss++;
-            root = bst_insert(root, randomNumber, "d");
+            root = bst_insert(arena, root, key, "d");
         } else {
             hit++;
         }
@@ -305,836 +395,2424 @@ struct bst_node* bst_search_and_insert(int n) {
 }
 
 /**
- * Get time of "n" search-and-insert operation in a Binary Search Tree
- * @param n number of keys to search and insert
- * @param record data_point record
+ * Insert n keys in a Binary Search Tree, then delete them in the same order
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert and delete
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return BST root node, empty unless keys were repeated
  */
-void bst_search_and_insert_time(int n, struct Records *record) {
-    clock_t start, end, w_start;
+void* bst_insert_and_delete(const int *keys, int n, struct arena *arena) {
+    struct bst_node* root = NULL;
 
-    struct bst_node *pt_clear_nodes[MAX_TIMES];
-    start = clock();
-    // Do the work.
-    double times[MAX_TIMES];
-    double times_sum = 0;
-    ssize_t z = 0;
-    do {
-        ssize_t k = 0;
-        do {
-            // Reset start time on every loop
-            w_start = clock();
-            // clearing the tree while taking times false the result, clear them at the end of the cycle
-            pt_clear_nodes[k + z] = bst_search_and_insert(n);
-            end = clock();
-            // Save amortized time
-            times[k + z] = (double) (end - w_start) / CLOCKS_PER_SEC / (double) n;
-            if (USE_MEDIAN == 0 )
-                times_sum += times[k + z]; // useful to calculate mean
-            k++;
-        } while ((double) (end - start) < ((double) resolution / ERROR_MAX + (double) resolution));
-        // clear bst trees
-        for (int j = z; j < k + z; j++) {
-            bst_clear(pt_clear_nodes[j]);
-            pt_clear_nodes[j] = NULL;
-        }
-        z = z + k;
-    } while (z < MIN_TIMES);
-
-    if (USE_MEDIAN == 1) {
-        double median = 0;
-        median = get_median(times, z);
-        double mad = 0;
-        mad = get_mad(times, z, median);
-        record->t1 = median;
-        record->d1 = mad;
-    } else {
-        // Average time
-        double mean;
-        mean = (double) times_sum / (double) (z);
-        // Standard deviation
-        double sd;
-        for (int i = 0; i < z; ++i) {
-            sd += pow(times[i] - mean, 2);
-        }
-        sd = sqrt(sd / z);
-        record->t1 = mean;
-        record->d1 = sd;
+    for (int i=0; i < n; i++) {
+        root = bst_insert(arena, root, keys[i], "d");
+    }
+    for (int i=0; i < n; i++) {
+        root = bst_delete(arena, root, keys[i]);
     }
+    return root;
 }
 
-
-/***********************************
- *  AVL
- ************************************/
-
-/**
- * Structure to represent each
- * node in an AVL binary search tree
- */
-typedef struct avl_node
-{
-    int key;
-    char *data;
-    int height;
-    struct avl_node *left;
-    struct avl_node *right;
-} avl_node;
-
 /**
- * Get the height of the node
- * @param avl_node AVL node
- * @return height of the node
+ * Remove all nodes of a Binary Search Tree
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param root BST root node
  */
-int height(struct avl_node* node)
-{
-    if (node == NULL)
-        return 0;
-    return node->height;
+void bst_release(struct arena *arena, void *root) {
+    bst_clear(arena, (struct bst_node *) root);
 }
 
 /**
- * Get maximum of two integers
- * @param a int first integer
- * @param b int second integer
- * @return max of two values
+ * Insert n sorted keys in a Binary Search Tree one by one
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return BST root node
  */
-int max(int aa, int bb)
-{
-    return (aa > bb)? aa : bb;
+void* bst_sorted_insert(const int *keys, int n, struct arena *arena) {
+    struct bst_node* root = NULL;
+
+    for (int i=0; i < n; i++) {
+        root = bst_insert(arena, root, keys[i], "d");
+    }
+    return root;
 }
 
 /**
- * Right rotate AVL subtree rooted with y
- * @param root avl_node AVL root
- * @return rotated AVL
+ * Bulk load n sorted keys in a Binary Search Tree
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to load
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return BST root node
  */
-struct avl_node* avl_right_rotate(struct avl_node* root)
-{
-    struct avl_node* x = root->left;
-    struct avl_node* T2 = x->right;
+void* bst_sorted_load(const int *keys, int n, struct arena *arena) {
+    struct pairs pairs;
+    sorted_pairs(&pairs, keys, n);
+    struct bst_node* root = bst_load(arena, NULL, &pairs);
+    pairs_free(&pairs);
+    return root;
+}
 
-    // Perform rotation
-    x->right = root;
-    root->left = T2;
+const struct tree_bench bst_bench = { bst_search_and_insert, bst_insert_and_delete, bst_release,
+                                         bst_sorted_insert, bst_sorted_load };
 
-    // Update heights
-    root->height = max(height(root->left), height(root->right))+1;
-    x->height = max(height(x->left), height(x->right))+1;
 
-    // Return new root
-    return x;
-}
+/***********************************
+ *  AVL
+ ************************************/
 
 /**
- * Left rotate AVL subtree rooted with y
- * @param root avl_node AVL root
- * @return rotated AVL
+ * Search and insert n keys in an AVL Binary Tree
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return AVL root node
  */
-struct avl_node *avl_left_rotate(struct avl_node* root)
-{
-    struct avl_node *y = root->right;
-    struct avl_node *T2 = y->left;
+void* avl_search_and_insert(const int *keys, int n, struct arena *arena) {
+    struct avl_node* root = NULL;
+    int hit = 0;
+    int miss = 0;
 
-    // Perform rotation
-    y->left = root;
-    root->right = T2;
+    for (int i=0; i < n; i++) {
+        int key = keys[i];
+        if (root == NULL || avl_find(root, key) == NULL) {
+            miss++;
+            root = avl_insert(arena, root, key, "d");
+        } else {
+            hit++;
+        }
+    }
+    //printf("hit: %d / miss: %d\n", hit, miss);
+    return root;
+}
 
-    //  Update heights
-    root->height = max(height(root->left), height(root->right))+1;
-    y->height = max(height(y->left), height(y->right))+1;
+/**
+ * Insert n keys in an AVL Binary Tree, then delete them in the same order
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert and delete
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return AVL root node, empty unless keys were repeated
+ */
+void* avl_insert_and_delete(const int *keys, int n, struct arena *arena) {
+    struct avl_node* root = NULL;
 
-    // Return new root
-    return y;
+    for (int i=0; i < n; i++) {
+        root = avl_insert(arena, root, keys[i], "d");
+    }
+    for (int i=0; i < n; i++) {
+        root = avl_delete(arena, root, keys[i]);
+    }
+    return root;
 }
 
 /**
- * Get balance factor of node N
- * @param node avl_node
- * @return balance factor
+ * Remove all nodes of an AVL Binary Tree
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param root AVL root node
  */
-int getBalance(struct avl_node* node)
-{
-    if (node == NULL)
-        return 0;
-    return height(node->left) - height(node->right);
+void avl_release(struct arena *arena, void *root) {
+    avl_clear(arena, (struct avl_node *) root);
 }
 
 /**
- * Create a new avl_node
- * @param key node key
- * @param data node value
- * @return new avl node
+ * Insert n sorted keys in an AVL Tree one by one
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return AVL root node
  */
-struct avl_node* avl_create(int key, char *data)
-{
-    struct avl_node *new_node;
-    new_node = (struct avl_node *) malloc(sizeof(avl_node));
-    if (new_node == NULL)
-    {
-        fprintf (stderr, "create avl node fail\n");
-        exit(1);
-    }
-    new_node->key = key;
-    new_node->data = strdup(data);
-    new_node->left = NULL;
-    new_node->right = NULL;
-    new_node->height = 1;
+void* avl_sorted_insert(const int *keys, int n, struct arena *arena) {
+    struct avl_node* root = NULL;
 
-    return new_node;
+    for (int i=0; i < n; i++) {
+        root = avl_insert(arena, root, keys[i], "d");
+    }
+    return root;
 }
 
 /**
- * Insert new node in an AVL
- * @param avl_node AVL root
- * @param key key to insert
- * @param data value to insert
- * @return AVL with new node
+ * Bulk load n sorted keys in an AVL Tree
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to load
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return AVL root node
  */
-struct avl_node* avl_insert(struct avl_node *node, int key, char *data) {
-    // Return a new avl_node if the tree is empty
-    if (node == NULL)
-    {
-        return avl_create(key, data);
-    }
+void* avl_sorted_load(const int *keys, int n, struct arena *arena) {
+    struct pairs pairs;
+    sorted_pairs(&pairs, keys, n);
+    struct avl_node* root = avl_load(arena, NULL, &pairs);
+    pairs_free(&pairs);
+    return root;
+}
 
-    // Traverse to the right place and insert the node
-    if (key < node->key) {
-        node->left = avl_insert(node->left, key, data);
-    } else if (key > node->key) {
-        node->right = avl_insert(node->right, key, data);
-    } else { // Equal keys are not allowed in AVL
-        return node;
-    }
+const struct tree_bench avl_bench = { avl_search_and_insert, avl_insert_and_delete, avl_release,
+                                         avl_sorted_insert, avl_sorted_load };
 
-    /* Update height of this node */
-    node->height = 1 + max(height(node->left), height(node->right));
 
-    // Get the balance factor of this node
-    // to check whether this node became unbalanced
-    int balance = getBalance(node);
+/***********************************
+ *  RBT
+ ************************************/
 
-    // If this node becomes unbalanced, then
-    // there are 4 cases
+/**
+ * Search and insert n keys in a Red-Black Tree
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return RBT root node
+ */
+void* rbt_search_and_insert(const int *keys, int n, struct arena *arena) {
+    struct rbt_node* root = T_Nil;
+    int hit = 0;
+    int miss = 0;
 
-    // Left Left Case
-    if (balance > 1 && key < node->left->key)
-        return avl_right_rotate(node);
+    for (int i=0; i < n; i++) {
+        int key = keys[i];
+        if (root == T_Nil || rbt_find(root, key) == NULL) {
+            miss++;
+            root = rbt_insert(arena, root, key, "d");
+        } else {
+            hit++;
+        }
+    }
+    //printf("hit: %d / miss: %d\n", hit, miss);
+    return root;
+}
 
-    // Right Right Case
-    if (balance < -1 && key > node->right->key)
-        return avl_left_rotate(node);
+/**
+ * Insert n keys in a Red-Black Tree, then delete them in the same order
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert and delete
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return RBT root node, empty unless keys were repeated
+ */
+void* rbt_insert_and_delete(const int *keys, int n, struct arena *arena) {
+    struct rbt_node* root = T_Nil;
 
-    // Left Right Case
-    if (balance > 1 && key > node->left->key)
-    {
-        node->left =  avl_left_rotate(node->left);
-        return avl_right_rotate(node);
+    for (int i=0; i < n; i++) {
+        root = rbt_insert(arena, root, keys[i], "d");
     }
-
-    // Right Left Case
-    if (balance < -1 && key < node->right->key)
-    {
-        node->right = avl_right_rotate(node->right);
-        return avl_left_rotate(node);
+    for (int i=0; i < n; i++) {
+        root = rbt_delete(arena, root, keys[i]);
     }
+    return root;
+}
 
-    /* return the (unchanged) avl root */
-    return node;
+/**
+ * Remove all nodes of a Red-Black Tree
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param root RBT root node
+ */
+void rbt_release(struct arena *arena, void *root) {
+    rbt_clear(arena, (struct rbt_node *) root);
 }
 
 /**
- * Search a node with key and, if found, return its value
- * @param avl_node AVL to search for the key
- * @param key key to search
+ * Insert n sorted keys in a Red-Black Tree one by one
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return RBT root node
  */
-const char* avl_find(struct avl_node* node, int key) {
-    if (node->key == key)
-        return node->data;
-    if (node->key < key) {
-        if (node->right != NULL)
-            return avl_find(node->right, key);
-    } else {
-        if (node->left != NULL)
-            return avl_find(node->left, key);
+void* rbt_sorted_insert(const int *keys, int n, struct arena *arena) {
+    struct rbt_node* root = T_Nil;
+
+    for (int i=0; i < n; i++) {
+        root = rbt_insert(arena, root, keys[i], "d");
     }
-    return strdup("");
+    return root;
 }
 
 /**
- * Remove all nodes from AVL
- * Given an AVL binary tree, remove its nodes in postorder (left, right, root)
- * @param node
+ * Bulk load n sorted keys in a Red-Black Tree
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to load
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return RBT root node
  */
-void avl_clear(struct avl_node* node) {
-    if (node == NULL)
-        return;
+void* rbt_sorted_load(const int *keys, int n, struct arena *arena) {
+    struct pairs pairs;
+    sorted_pairs(&pairs, keys, n);
+    struct rbt_node* root = rbt_load(arena, T_Nil, &pairs);
+    pairs_free(&pairs);
+    return root;
+}
 
-    // first recur on left subtree
-    avl_clear(node->left);
+const struct tree_bench rbt_bench = { rbt_search_and_insert, rbt_insert_and_delete, rbt_release,
+                                         rbt_sorted_insert, rbt_sorted_load };
 
-    // then recur on right subtree
-    avl_clear(node->right);
 
-    // now deal with the node
-    free(node);
-    node = NULL;
-}
+/***********************************
+ *  RBT, packed color
+ ************************************/
 
 /**
- * Show current AVL with prefix expression (Polish notation)
- * Given an AVL binary tree, print its nodes in preorder (root, left, right)
- * @param avl_node avl to traverse
+ * Search and insert n keys in a Red-Black Tree with the color in the parent pointer
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return packed RBT root node
  */
-void avl_show(struct avl_node* node)
-{
-    if (node == NULL) {
-        printf("NULL ");
-        return;
+void* rbtp_search_and_insert(const int *keys, int n, struct arena *arena) {
+    struct rbtp_node* root = TP_Nil;
+
+    for (int i=0; i < n; i++) {
+        int key = keys[i];
+        if (root == TP_Nil || rbtp_find(root, key) == NULL)
+            root = rbtp_insert(arena, root, key, "d");
     }
+    return root;
+}
 
-    /* first print data of avl_node */
-    printf("%d:%s:%d ", node->key, node->data, node->height);
+/**
+ * Remove all nodes of a Red-Black Tree with the color in the parent pointer
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param root packed RBT root node
+ */
+void rbtp_release(struct arena *arena, void *root) {
+    rbtp_clear(arena, (struct rbtp_node *) root);
+}
 
-    /* then recur on left subtree */
-    avl_show(node->left);
+// insert-and-delete is not available on packed RBT
+const struct tree_bench rbtp_bench = { .search_and_insert = rbtp_search_and_insert,
+                                       .clear = rbtp_release };
 
-    /* now recur on right subtree */
-    avl_show(node->right);
-}
+
+/***********************************
+ *  B-tree
+ ************************************/
 
 /**
- * Search and insert n keys in an AVL Binary Tree
+ * Search and insert n keys in a B-tree
+ * @param keys keys of the workload, drawn ahead of the measure
  * @param n number of keys to search and insert
- * @return AVL root node
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return B-tree root node
  */
-struct avl_node* avl_search_and_insert(int n) {
-    struct avl_node* root = NULL;
-    char result[2] = "";
-    int hit = 0;
-    int miss = 0;
+void* btree_search_and_insert(const int *keys, int n, struct arena *arena) {
+    struct btree_node* root = NULL;
 
     for (int i=0; i < n; i++) {
-        // In the GNU C Library the largest value the rand function can return is 2147483647.
-        int randomNumber;
-        randomNumber = rand();
-        if (root != NULL)
-            strcpy(result, avl_find(root, randomNumber));
-        if ((strcmp(result, "d") != 0)) {
-            miss++;
-            root = avl_insert(root, randomNumber, "d");
-        } else {
-            hit++;
-        }
+        int key = keys[i];
+        if (root == NULL || btree_find(root, key) == NULL)
+            root = btree_insert(arena, root, key, "d");
     }
-    //printf("hit: %d / miss: %d\n", hit, miss);
     return root;
 }
 
 /**
- * Get time of "n" search-and-insert operations in an AVL Tree
- * @param n number of keys to search and insert
- * @param record data_point record
+ * Insert n keys in a B-tree, then delete them in the same order
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to insert and delete
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return B-tree root node, empty
  */
-void avl_search_and_insert_time(int n, struct Records *record) {
-    clock_t start, end, w_start;
+void* btree_insert_and_delete(const int *keys, int n, struct arena *arena) {
+    struct btree_node* root = NULL;
 
-    struct avl_node* pt_clear_nodes[MAX_TIMES];
-    start = clock();
-    // Do the work.
-    double times[MAX_TIMES];
-    double times_sum = 0;
-    ssize_t z = 0;
-    do {
-        ssize_t k = 0;
-        do {
-            // Reset start time on every loop
-            w_start = clock();
-            // clearing the tree while taking times false the result, clear them at the end of the cycle
-            pt_clear_nodes[k+z] = avl_search_and_insert(n);
-            end = clock();
-            // Save amortized time
-            times[k+z] = (double) (end - w_start) / CLOCKS_PER_SEC / (double) n;
-            if (USE_MEDIAN == 0)
-              times_sum += times[k]; // useful to calculate mean
-            k++;
-            // short-circuit evaluation
-        } while ((double) (end - start) < ((double) resolution / ERROR_MAX + (double) resolution));
-        // clear avl trees
-        for (int j = z; j < k+z; j++) {
-            avl_clear(pt_clear_nodes[j]);
-            pt_clear_nodes[j] = NULL;
-        }
-        z = z+k;
-    } while (z < MIN_TIMES);
-
-    if (USE_MEDIAN == 1) {
-        double median = 0;
-        median = get_median(times, z);
-        double mad = 0;
-        mad = get_mad(times, z, median);
-        record->t2 = median;
-        record->d2 = mad;
-    } else {
-        // Average time
-        double mean;
-        mean = (double) times_sum / (double) (z);
-        // Standard deviation
-        double sd;
-        for (int i = 0; i < z; ++i) {
-            sd += pow(times[i] - mean, 2);
-        }
-        sd = sqrt(sd / (double) z);
-        record->t2 = mean;
-        record->d2 = sd;
+    for (int i=0; i < n; i++) {
+        root = btree_insert(arena, root, keys[i], "d");
+    }
+    for (int i=0; i < n; i++) {
+        root = btree_delete(arena, root, keys[i]);
     }
+    return root;
 }
 
+/**
+ * Remove all nodes of a B-tree
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param root B-tree root node
+ */
+void btree_release(struct arena *arena, void *root) {
+    btree_clear(arena, (struct btree_node *) root);
+}
+
+const struct tree_bench btree_bench = { .search_and_insert = btree_search_and_insert,
+                                        .insert_and_delete = btree_insert_and_delete,
+                                        .clear = btree_release };
 
 /***********************************
- *  RBT
+ *  Index layout
  ************************************/
 
-/**
- * Enum to represent each
- * node color in a red-black tree
- */
-enum nodeColor {
-    BLACK,
-    RED
+/* Tree on a node pool, its root is an index */
+struct ix_tree {
+    struct ix_pool pool;
+    uint32_t root;
 };
 
-/**
- * Structure to represent each
- * node in a red-black tree
- */
-typedef struct rbt_node
-{
-    int key;
-    char *data;
-    enum nodeColor color;
-    struct rbt_node *parent;
-    struct rbt_node *left;
-    struct rbt_node *right;
-} rbt_node;
-
-// Use T_Nil as a sentinel to simplify code
-struct rbt_node *T_Nil;
+/* Insert and find functions of a tree on a node pool */
+typedef uint32_t (*ix_insert_fn)(struct ix_pool *pool, uint32_t root, int key, char *data);
+typedef const char* (*ix_find_fn)(struct ix_pool *pool, uint32_t root, int key);
 
 /**
- * Creates a new node, initializes and returns a pointer to it.
- * @param key node key
- * @param data node value
- * @return rbt node
+ * Search and insert n keys in a tree on a node pool
+ * The pool starts small, so its growth is part of the measure as malloc calls are.
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param insert insert function of the tree
+ * @param find find function of the tree
+ * @return tree with its pool
  */
-struct rbt_node* rbt_create(int key, char *data)
-{
-    struct rbt_node *new_node;
-    new_node = (struct rbt_node *) malloc(sizeof(rbt_node));
-    if (new_node == NULL)
+struct ix_tree* ix_search_and_insert(const int *keys, int n, ix_insert_fn insert, ix_find_fn find) {
+    struct ix_tree *tree = (struct ix_tree *) malloc(sizeof(struct ix_tree));
+    if (tree == NULL)
     {
-        fprintf (stderr, "create rbt node fail\n");
+        fprintf (stderr, "create index tree fail\n");
         exit(1);
     }
-    new_node->key = key;
-    new_node->data = strdup(data);
-    new_node->color = RED;
-    new_node->left = NULL;
-    new_node->right = NULL;
-    new_node->parent = NULL;
+    ix_pool_init(&tree->pool, 16);
+    tree->root = IX_NIL;
 
-    return new_node;
+    for (int i=0; i < n; i++) {
+        int key = keys[i];
+        if (tree->root == IX_NIL || find(&tree->pool, tree->root, key) == NULL)
+            tree->root = insert(&tree->pool, tree->root, key, "d");
+    }
+    return tree;
 }
 
 /**
- * Left rotate RBT subtree rooted with x
- * @param root rbt_node RBT root
- * @param x rbt_node node to rotate
- * @return rotated RBT
+ * Search and insert n keys in a BST on a node pool
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param arena unused, nodes come from the pool
+ * @return tree with its pool
  */
-struct rbt_node* rbt_left_rotate(rbt_node* root, rbt_node* x)
-{
-    // y stored pointer of right child of x
-    rbt_node *y = x->right;
-    // store y's left subtree's pointer as x's right child
-    x->right = y->left;
-    // update parent pointer of y's left
-    if (y->left != T_Nil)
-        y->left->parent = x;
-    // link x's parent to y
-    y->parent = x->parent;
-    // if x's parent is T_Nil make y as root of tree
-    if (x->parent == T_Nil)
-        root = y;
-    else if (x == x->parent->left)
-        x->parent->left = y;
-    else
-        x->parent->right = y;
-    // make x as left child of y
-    y->left = x;
-    // update parent pointer of x
-    x->parent = y;
+void* bst_ix_search_and_insert(const int *keys, int n, struct arena *arena) {
+    (void) arena;
+    return ix_search_and_insert(keys, n, bst_ix_insert, bst_ix_find);
+}
 
-    // Return new root
-    return root;
+/**
+ * Search and insert n keys in an AVL on a node pool
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param arena unused, nodes come from the pool
+ * @return tree with its pool
+ */
+void* avl_ix_search_and_insert(const int *keys, int n, struct arena *arena) {
+    (void) arena;
+    return ix_search_and_insert(keys, n, avl_ix_insert, avl_ix_find);
 }
 
 /**
- * Right rotate RBT subtree rooted with y
- * @param root rbt_node RBT root
- * @param y rbt_node node to rotate
- * @return rotated RBT
+ * Search and insert n keys in a RBT on a node pool
+ * @param keys keys of the workload, drawn ahead of the measure
+ * @param n number of keys to search and insert
+ * @param arena unused, nodes come from the pool
+ * @return tree with its pool
  */
-struct rbt_node* rbt_right_rotate(rbt_node* root, rbt_node* y)
-{
-    // x stored pointer of left child of y
-    rbt_node *x = y->left;
-    // turn x's right subtree into y's left subtree
-    y->left = x->right;
-    // update parent pointer of x's right
-    if (x->right != T_Nil)
-        x->right->parent = y;
-    // update x's parent pointer
-    x->parent = y->parent;
-    // if y's parent is T_Nil make x as root of tree
-    if (y->parent == T_Nil)
-        root = x;
-    else if (y == y->parent->right)
-        y->parent->right = x;
-    else
-        y->parent->left  = x;
-    // make y as right child of x
-    x->right = y;
-    // update parent pointer of y
-    y->parent = x;
+void* rbt_ix_search_and_insert(const int *keys, int n, struct arena *arena) {
+    (void) arena;
+    return ix_search_and_insert(keys, n, rbt_ix_insert, rbt_ix_find);
+}
 
-    // Return new root
-    return root;
+/**
+ * Free a tree on a node pool
+ * @param arena unused, nodes come from the pool
+ * @param root tree with its pool
+ */
+void ix_release(struct arena *arena, void *root) {
+    struct ix_tree *tree = (struct ix_tree *) root;
+    (void) arena;
+    ix_pool_free(&tree->pool);
+    free(tree);
 }
 
+// insert-and-delete is not available on node pools
+const struct tree_bench bst_ix_bench = { .search_and_insert = bst_ix_search_and_insert,
+                                         .clear = ix_release };
+const struct tree_bench avl_ix_bench = { .search_and_insert = avl_ix_search_and_insert,
+                                         .clear = ix_release };
+const struct tree_bench rbt_ix_bench = { .search_and_insert = rbt_ix_search_and_insert,
+                                         .clear = ix_release };
+
+/* BST, AVL, RBT and B-tree measured for each layout (no B-tree on the index layout) */
+const struct tree_bench *pointer_layout[] = { &bst_bench, &avl_bench, &rbt_bench, &btree_bench };
+const struct tree_bench *index_layout[] = { &bst_ix_bench, &avl_ix_bench, &rbt_ix_bench, NULL };
+/* BST, AVL and RBT measured for bulk load */
+const struct tree_bench *load_trees[] = { &bst_bench, &avl_bench, &rbt_bench, NULL };
+
+
+/***********************************
+ *  Times
+ ************************************/
+
 /**
- * Resort the Red-Black tree properties
- * @param root RBT root
- * @param node node to fixup
- * @return RBT root node
+ * Get average and median of amortized times
+ * @param times amortized times, overwritten
+ * @param z number of times
+ * @param time average and median amortized time, by statistic
+ * @param deviation standard deviation and median absolute deviation, by statistic
  */
-struct rbt_node* fixup(rbt_node* root, rbt_node* node)
-{
-    rbt_node* temp;
-    while (node->parent->color == RED)
+void get_statistics(double times[], int z, double time[STATISTICS], double deviation[STATISTICS]) {
+    // Average time
+    double mean = 0;
+    for (int i = 0; i < z; ++i)
+        mean += times[i];
+    mean = mean / (double) z;
+    // Standard deviation
+    double sd = 0;
+    for (int i = 0; i < z; ++i) {
+        sd += pow(times[i] - mean, 2);
+    }
+    sd = sqrt(sd / (double) z);
+    time[MEAN] = mean;
+    deviation[MEAN] = sd;
+    // median last: get_median sorts times and get_mad overwrites them
+    double median = get_median(times, z);
+    time[MEDIAN] = median;
+    deviation[MEDIAN] = get_mad(times, z, median);
+}
+
+/**
+ * Get average or median of amortized times, as chosen by the options
+ * @param times amortized times, overwritten
+ * @param z number of times
+ * @param time average or median amortized time
+ * @param deviation standard deviation or median absolute deviation
+ */
+void get_statistic(double times[], int z, double *time, double *deviation) {
+    double times_statistics[STATISTICS];
+    double deviation_statistics[STATISTICS];
+    get_statistics(times, z, times_statistics, deviation_statistics);
+    *time = times_statistics[options.statistic];
+    *deviation = deviation_statistics[options.statistic];
+}
+
+/**
+ * Get time of "n" operations of a workload on a tree
+ * WARM_UP_RUNS runs are not timed: caches, branch predictors and the
+ * allocator reach their steady state before the measures.
+ * @param tree tree to measure
+ * @param n number of keys of the workload
+ * @param use_arena allocate nodes from arenas instead of malloc
+ * @param workload operations to time
+ * @param time average and median amortized time, by statistic
+ * @param deviation standard deviation and median absolute deviation, by statistic
+ * @param cpu_time average and median amortized CPU time of the same runs, NULL not to measure it
+ * @param cpu_deviation standard deviation and median absolute deviation of CPU time
+ * @param counters events of each hardware counter per operation, counted on the timed runs,
+ *                 NULL not to count them
+ */
+void tree_time(const struct tree_bench *tree, int n, int use_arena, enum workload workload,
+               double time[], double deviation[], double cpu_time[], double cpu_deviation[], double *counters) {
+    long long start, end, w_start, cpu_start = 0;
+
+    workload_fn run;
+    switch (workload) {
+        case INSERT_AND_DELETE:
+            run = tree->insert_and_delete;
+            break;
+        case SORTED_INSERT:
+            run = tree->sorted_insert;
+            break;
+        case SORTED_LOAD:
+            run = tree->sorted_load;
+            break;
+        default:
+            run = tree->search_and_insert;
+    }
+    // sorted workloads insert sorted keys, the others the keys of the workload option
+    struct key_workload *key_workload = (workload == SORTED_INSERT || workload == SORTED_LOAD)
+                                        ? &sorted_keys : &options.keys;
+    int *keys = (int *) malloc(n * sizeof(int));
+    void **pt_clear_nodes = (void **) malloc(options.max_times * sizeof(void *));
+    struct arena *arenas = (struct arena *) malloc(options.max_times * sizeof(struct arena));
+    double *times = times_alloc();
+    double *cpu_times = times_alloc();
+    if (keys == NULL || pt_clear_nodes == NULL || arenas == NULL)
     {
-        /* Case : A
-         * Parent of node is left child
-         * of Grand-parent of node
-         */
-        if (node->parent == node->parent->parent->left)
-        {
-            temp = node->parent->parent->right;
-            /* Case : 1
-             *   The uncle of node is also red
-             *   Only Recoloring required
-             */
-            if (temp->color == RED)
-            {
-                node->parent->color = BLACK;
-                temp->color = BLACK;
-                node->parent->parent->color = RED;
-                node = node->parent->parent;
-            }
-            else {
-                /* Case : 2
-                 *   node is right child of its parent
-                 *   Left-rotation required
-                 */
-                if (node == node->parent->right)
-                {
-                    node = node->parent;
-                    root = rbt_left_rotate(root, node);
-                }
-                /* Case : 3
-                 *   node is left child of its parent
-                 *   Right-rotation required
-                 */
-                node->parent->color = BLACK;
-                node->parent->parent->color = RED;
-                root = rbt_right_rotate(root, node->parent->parent);
-            }
+        fprintf (stderr, "create times array fail\n");
+        exit(1);
+    }
+    for (int w = 0; w < WARM_UP_RUNS; w++) {
+        key_workload_fill(key_workload, &keys_prng, keys, n);
+        if (use_arena) {
+            arena_init(&arenas[0], ARENA_SLAB_SIZE);
+            run(keys, n, &arenas[0]);
+            arena_free(&arenas[0]);
+        } else {
+            tree->clear(NULL, run(keys, n, NULL));
         }
-        else
-        {
-            /* Case : B
-             *   Parent of node is right child
-             *   of Grand-parent of node
-             */
-            temp = node->parent->parent->left;
-            /* Case : 1
-             *   The uncle of node is also red
-             *   Only Recoloring required
-             */
-            if (temp->color == RED)
-            {
-                node->parent->color = BLACK;
-                temp->color = BLACK;
-                node->parent->parent->color = RED;
-                node = node->parent->parent;
-            }
-            else {
-                /* Case : 2
-                 *  node is left child of its parent
-                 *  Right-rotation required
-                 */
-                if (node == node->parent->left)
-                {
-                    node = node->parent;
-                    root = rbt_right_rotate(root, node);
-                }
-                /* Case : 3
-                 * node is right child of its parent
-                 * Left-rotation required
-                 */
-                node->parent->color = BLACK;
-                node->parent->parent->color = RED;
-                root = rbt_left_rotate(root, node->parent->parent);
+    }
+    if (counters != NULL)
+        perf_counters_reset(&perf);
+    start = clock_ns();
+    // Do the work.
+    ssize_t z = 0;
+    do {
+        ssize_t k = 0;
+        do {
+            // nodes of each tree live in their own arena, if requested
+            struct arena *arena = NULL;
+            if (use_arena) {
+                arena = &arenas[k + z];
+                arena_init(arena, ARENA_SLAB_SIZE);
             }
+            // keys of every run are drawn again, out of the measure
+            key_workload_fill(key_workload, &keys_prng, keys, n);
+            // Reset start time on every loop
+            if (counters != NULL)
+                perf_counters_start(&perf);
+            if (cpu_time != NULL)
+                cpu_start = cpu_ns();
+            w_start = clock_ns();
+            // clearing the tree while taking times false the result, clear them at the end of the cycle
+            pt_clear_nodes[k + z] = run(keys, n, arena);
+            end = clock_ns();
+            if (counters != NULL)
+                perf_counters_stop(&perf);
+            // Save amortized time
+            times[k + z] = (double) (end - w_start) / 1e9 / (double) n;
+            if (cpu_time != NULL)
+                cpu_times[k + z] = (double) (cpu_ns() - cpu_start) / 1e9 / (double) n;
+            k++;
+        } while ((double) (end - start) < ((double) resolution / options.error_max + (double) resolution)
+                 && k + z < options.max_times);
+        // clear trees
+        for (int j = z; j < k + z; j++) {
+            if (use_arena)
+                arena_free(&arenas[j]);
+            else
+                tree->clear(NULL, pt_clear_nodes[j]);
+            pt_clear_nodes[j] = NULL;
         }
+        z = z + k;
+    } while (z < options.min_times && z < options.max_times);
+
+    get_statistics(times, z, time, deviation);
+    if (cpu_time != NULL)
+        get_statistics(cpu_times, z, cpu_time, cpu_deviation);
+    if (counters != NULL) {
+        for (int i = 0; i < PERF_COUNTERS; i++)
+            counters[i] = perf_counters_available(&perf, (enum perfCounter) i)
+                          ? perf.counts[i] / (double) z / (double) n : NAN;
     }
-    root->color = BLACK;
-    return root;
+    free(keys);
+    free(pt_clear_nodes);
+    free(arenas);
+    free(times);
+    free(cpu_times);
 }
 
 /**
- * Insert new node in a RBT
- * @param node RBT root
- * @param key key to insert
- * @param data value to insert
+ * Set a measure to NAN, for trees not measured
+ * @param time time, by statistic
+ * @param deviation deviation, by statistic
  */
-struct rbt_node* rbt_insert(struct rbt_node *node, int key, char* data)
-{
-    rbt_node* z = rbt_create(key, data);
-    rbt_node* y = T_Nil;
-    rbt_node* x = node;
-
-    // Find where to Insert new node Z into the RBT
-    while (x != T_Nil) {
-        y = x;
-        if (z->key < x->key)
-            x = x->left;
-        else
-            x = x->right;
+void set_nan(double time[], double deviation[]) {
+    for (int s = 0; s < STATISTICS; s++) {
+        time[s] = NAN;
+        deviation[s] = NAN;
     }
+}
 
-    z->parent = y;
-    if (y == T_Nil)
-        node = z;
-    else if (z->key < y->key)
-        y->left  = z;
-    else
-        y->right = z;
+/**
+ * Get time of one of BST, AVL, RBT and B-tree for a data point, NAN if the tree is not selected
+ * or is a BST of more than BST_SORTED_MAX_N sorted keys
+ * @param trees BST, AVL, RBT and B-tree (or NULL) to measure
+ * @param t index of the tree in trees
+ * @param n number of keys of the workload
+ * @param use_arena allocate nodes from arenas instead of malloc
+ * @param workload operations to time
+ * @param time average and median amortized time, by statistic
+ * @param deviation standard deviation and median absolute deviation, by statistic
+ * @param cpu_time CPU time of the same runs, NULL not to measure it
+ * @param cpu_deviation deviation of CPU time
+ * @param counters hardware counters of the same runs, NULL not to count them
+ */
+void selected_tree_time(const struct tree_bench *trees[], int t, int n, int use_arena, enum workload workload,
+                        double time[], double deviation[], double cpu_time[], double cpu_deviation[],
+                        double *counters) {
+    // BST with sorted keys is a list: quadratic, its depth only grows
+    int sorted = workload == SORTED_INSERT || (workload != SORTED_LOAD && key_workload_sorted(&options.keys));
+    int bst_list = t == 0 && sorted && n > BST_SORTED_MAX_N;
+    if (trees[t] != NULL && (options.trees & (1 << t)) && !bst_list) {
+        tree_time(trees[t], n, use_arena, workload, time, deviation, cpu_time, cpu_deviation, counters);
+        return;
+    }
+    set_nan(time, deviation);
+    if (cpu_time != NULL)
+        set_nan(cpu_time, cpu_deviation);
+    if (counters != NULL)
+        for (int i = 0; i < PERF_COUNTERS; i++)
+            counters[i] = NAN;
+}
+
+/**
+ * Get time of BST, AVL, RBT and B-tree for a data point
+ * Trees not selected by the options, and missing ones, get NAN.
+ * @param trees BST, AVL, RBT and B-tree (or NULL) to measure
+ * @param n number of keys of the workload
+ * @param use_arena allocate nodes from arenas instead of malloc
+ * @param workload operations to time
+ * @param record data_point record
+ * @param cpu_record CPU times of the same runs, NULL not to measure them
+ * @param counters hardware counters of the same runs, NULL not to count them
+ */
+void trees_time(const struct tree_bench *trees[], int n, int use_arena, enum workload workload, struct Records *record,
+                struct Records *cpu_record, struct Counters *counters) {
+    record->n = n;
+    if (cpu_record != NULL)
+        cpu_record->n = n;
+    // Get time of a Binary Search Tree
+    selected_tree_time(trees, 0, n, use_arena, workload, record->t1, record->d1,
+                       cpu_record ? cpu_record->t1 : NULL, cpu_record ? cpu_record->d1 : NULL,
+                       counters ? counters->c[0] : NULL);
+    // Get time of an AVL Tree
+    selected_tree_time(trees, 1, n, use_arena, workload, record->t2, record->d2,
+                       cpu_record ? cpu_record->t2 : NULL, cpu_record ? cpu_record->d2 : NULL,
+                       counters ? counters->c[1] : NULL);
+    // Get time of a Red-Black Tree
+    selected_tree_time(trees, 2, n, use_arena, workload, record->t3, record->d3,
+                       cpu_record ? cpu_record->t3 : NULL, cpu_record ? cpu_record->d3 : NULL,
+                       counters ? counters->c[2] : NULL);
+    // Get time of a B-tree
+    selected_tree_time(trees, 3, n, use_arena, workload, record->t4, record->d4,
+                       cpu_record ? cpu_record->t4 : NULL, cpu_record ? cpu_record->d4 : NULL,
+                       counters ? counters->c[3] : NULL);
+}
 
-    // Init z as a red leaf
-    z->left  = T_Nil;
-    z->right = T_Nil;
-    z->color = RED;
 
-    // Ensure the Red-Black property is maintained
-    node = fixup(node, z);
-    return node;
+
+/***********************************
+ *  Find on frozen trees
+ ************************************/
+
+/* Find function of a tree built once, out of the measure */
+typedef const char* (*find_fn)(const void *tree, int key);
+
+/* Number of keys found, so finds are not optimized away */
+long found_keys;
+
+/**
+ * Find a key in an AVL
+ * @param tree AVL root node
+ * @param key key to search
+ * @return key data if key exist, NULL otherwise
+ */
+const char* avl_find_key(const void *tree, int key) {
+    return avl_find((struct avl_node *) tree, key);
 }
 
 /**
- * Search a node with key and, if found, print its value
- * @param node BST to search for the key
+ * Find a key in a Red-Black Tree
+ * @param tree RBT root node
  * @param key key to search
+ * @return key data if key exist, NULL otherwise
  */
-const char* rbt_find(struct rbt_node* node, int key) {
-    if (node->key == key) {
-        return node->data;
-    } else if (node->key < key) {
-        if (node->right != T_Nil)
-            return rbt_find(node->right, key);
-    } else {
-        if (node->left != T_Nil)
-            return rbt_find(node->left, key);
+const char* rbt_find_key(const void *tree, int key) {
+    return rbt_find((struct rbt_node *) tree, key);
+}
+
+/**
+ * Find a key in a frozen tree
+ * @param tree frozen tree
+ * @param key key to search
+ * @return key data if key exist, NULL otherwise
+ */
+const char* frozen_find_key(const void *tree, int key) {
+    return frozen_find((const struct frozen *) tree, key);
+}
+
+/**
+ * Get time of "n" finds on a tree
+ * @param find find function of the tree
+ * @param tree tree to search
+ * @param probes keys to find
+ * @param n number of keys to find
+ * @param time average and median amortized time, by statistic
+ * @param deviation standard deviation and median absolute deviation, by statistic
+ */
+void find_time(find_fn find, const void *tree, const int *probes, int n, double time[], double deviation[]) {
+    long long start, end, w_start;
+    double *times = times_alloc();
+    ssize_t z = 0;
+
+    start = clock_ns();
+    do {
+        // Reset start time on every loop
+        w_start = clock_ns();
+        for (int i = 0; i < n; i++) {
+            if (find(tree, probes[i]) != NULL)
+                found_keys++;
+        }
+        end = clock_ns();
+        // Save amortized time
+        times[z] = (double) (end - w_start) / 1e9 / (double) n;
+        z++;
+    } while ((z < options.min_times || (double) (end - start) < ((double) resolution / options.error_max + (double) resolution))
+             && z < options.max_times);
+
+    get_statistics(times, z, time, deviation);
+    free(times);
+}
+
+/**
+ * Get find time of AVL, RBT and of the AVL frozen in Eytzinger and van Emde Boas layouts
+ * The trees hold the n keys of the workload, all of them are searched in random order.
+ * @param n number of keys
+ * @param record data_point record: AVL, RBT, Eytzinger and van Emde Boas times
+ */
+void frozen_trees_time(int n, struct Records *record) {
+    struct avl_node *avl = NULL;
+    struct rbt_node *rbt = T_Nil;
+    struct frozen eytzinger;
+    struct frozen veb;
+    int *probes = workload_keys(n);
+
+    for (int i = 0; i < n; i++) {
+        avl = avl_insert(NULL, avl, probes[i], "d");
+        rbt = rbt_insert(NULL, rbt, probes[i], "d");
+    }
+    // search keys in another order than insertion
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int) prng_below(&keys_prng, (uint32_t) i + 1);
+        int key = probes[i];
+        probes[i] = probes[j];
+        probes[j] = key;
     }
-    return strdup("");
+    frozen_init(&eytzinger);
+    frozen_init(&veb);
+    avl_freeze(&eytzinger, avl, EYTZINGER);
+    avl_freeze(&veb, avl, VAN_EMDE_BOAS);
+
+    record->n = n;
+    find_time(avl_find_key, avl, probes, n, record->t1, record->d1);
+    find_time(rbt_find_key, rbt, probes, n, record->t2, record->d2);
+    find_time(frozen_find_key, &eytzinger, probes, n, record->t3, record->d3);
+    find_time(frozen_find_key, &veb, probes, n, record->t4, record->d4);
+
+    frozen_free(&eytzinger);
+    frozen_free(&veb);
+    avl_free_nodes(avl);
+    rbt_free_nodes(rbt);
+    free(probes);
 }
 
+
+/***********************************
+ *  Batch insert
+ ************************************/
+
+/* Insert function of a tree: keys one by one (batch 0) or in batches of batch keys */
+typedef void* (*batch_fn)(void *root, const int *keys, int count, int batch, struct arena *arena);
+
+/* Tree measured with batches */
+struct batch_bench {
+    workload_fn search_and_insert;                   // build the tree the keys are inserted in
+    batch_fn insert;                                 // insert keys one by one or in batches
+};
+
 /**
- * Remove all nodes from RBT
- * Given a RBT, remove its nodes in postorder (left, right, root)
- * @param node
+ * Insert keys in a Binary Search Tree
+ * @param root BST root node
+ * @param keys keys to insert
+ * @param count number of keys
+ * @param batch number of keys of each batch, 0 to insert them one by one
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return BST root node
  */
-void rbt_clear(struct rbt_node* node) {
-    if (node == NULL || node == T_Nil)
-        return;
+void* bst_insert_keys(void *root, const int *keys, int count, int batch, struct arena *arena) {
+    struct bst_node *node = (struct bst_node *) root;
+    struct pairs pairs;
 
-    // first recur on left subtree
-    rbt_clear(node->left);
+    if (batch == 0) {
+        for (int i = 0; i < count; i++)
+            node = bst_insert(arena, node, keys[i], "d");
+        return node;
+    }
+    pairs_init(&pairs);
+    for (int i = 0; i < count; i++) {
+        pairs_add(&pairs, keys[i], "d");
+        if (pairs.count == batch || i == count - 1) {
+            node = bst_insert_batch(arena, node, &pairs);
+            pairs_clear(&pairs);
+        }
+    }
+    pairs_free(&pairs);
+    return node;
+}
 
-    // then recur on right subtree
-    rbt_clear(node->right);
+/**
+ * Insert keys in an AVL
+ * @param root AVL root node
+ * @param keys keys to insert
+ * @param count number of keys
+ * @param batch number of keys of each batch, 0 to insert them one by one
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return AVL root node
+ */
+void* avl_insert_keys(void *root, const int *keys, int count, int batch, struct arena *arena) {
+    struct avl_node *node = (struct avl_node *) root;
+    struct pairs pairs;
 
-    // now deal with the node
-    free(node);
-    node = T_Nil;
+    if (batch == 0) {
+        for (int i = 0; i < count; i++)
+            node = avl_insert(arena, node, keys[i], "d");
+        return node;
+    }
+    pairs_init(&pairs);
+    for (int i = 0; i < count; i++) {
+        pairs_add(&pairs, keys[i], "d");
+        if (pairs.count == batch || i == count - 1) {
+            node = avl_insert_batch(arena, node, &pairs);
+            pairs_clear(&pairs);
+        }
+    }
+    pairs_free(&pairs);
+    return node;
 }
 
 /**
- * Show current rbt with prefix expression (Polish notation)
- * Given a RBT, print its nodes in preorder (root, left, right)
- * @param node rbt to traverse
+ * Insert keys in a Red-Black Tree
+ * @param root RBT root node
+ * @param keys keys to insert
+ * @param count number of keys
+ * @param batch number of keys of each batch, 0 to insert them one by one
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @return RBT root node
  */
-void rbt_show(struct rbt_node* node)
-{
-    if (node == T_Nil) {
-        printf("NULL ");
+void* rbt_insert_keys(void *root, const int *keys, int count, int batch, struct arena *arena) {
+    struct rbt_node *node = (struct rbt_node *) root;
+    struct pairs pairs;
+
+    if (batch == 0) {
+        for (int i = 0; i < count; i++)
+            node = rbt_insert(arena, node, keys[i], "d");
+        return node;
+    }
+    pairs_init(&pairs);
+    for (int i = 0; i < count; i++) {
+        pairs_add(&pairs, keys[i], "d");
+        if (pairs.count == batch || i == count - 1) {
+            node = rbt_insert_batch(arena, node, &pairs);
+            pairs_clear(&pairs);
+        }
+    }
+    pairs_free(&pairs);
+    return node;
+}
+
+const struct batch_bench bst_batch_bench = { bst_search_and_insert, bst_insert_keys };
+const struct batch_bench avl_batch_bench = { avl_search_and_insert, avl_insert_keys };
+const struct batch_bench rbt_batch_bench = { rbt_search_and_insert, rbt_insert_keys };
+
+/**
+ * Get throughput of BATCH_KEYS keys inserted one by one and in batches in a tree of
+ * BATCH_TREE_SIZE keys, NAN for a BST of sorted keys. Keys of the tree and inserted
+ * ones come from the workload, building the tree and drawing the keys are not measured.
+ * Both ways insert the same keys in the same tree, each in its own arena, and take
+ * turns to run first, so that neither gets a younger heap or warmer caches.
+ * @param tree tree to measure
+ * @param batch number of keys of each batch
+ * @param single average or median keys inserted per second one by one
+ * @param single_deviation standard deviation or median absolute deviation one by one
+ * @param throughput average or median keys inserted per second in batches
+ * @param deviation standard deviation or median absolute deviation in batches
+ */
+void batch_time(const struct batch_bench *tree, int batch, double *single, double *single_deviation,
+                double *throughput, double *deviation) {
+    long long w_start, end;
+    struct arena arena;
+    // BST with sorted keys is a list, its inserts are quadratic
+    if (tree == &bst_batch_bench && key_workload_sorted(&options.keys)) {
+        *single = NAN;
+        *single_deviation = NAN;
+        *throughput = NAN;
+        *deviation = NAN;
         return;
     }
+    double *single_times = (double *) malloc(options.min_times * sizeof(double));
+    double *times = (double *) malloc(options.min_times * sizeof(double));
+    int *tree_keys = (int *) malloc(BATCH_TREE_SIZE * sizeof(int));
+    int *keys = (int *) malloc(BATCH_KEYS * sizeof(int));
+    if (tree_keys == NULL || keys == NULL || single_times == NULL || times == NULL)
+    {
+        fprintf (stderr, "create keys array fail\n");
+        exit(1);
+    }
 
-    char color[6];
-    if (node->color == BLACK) {
-        strcpy(color, "black");
-    } else {
-        strcpy(color, "red");
+    for (int z = 0; z < options.min_times; z++) {
+        key_workload_fill(&options.keys, &keys_prng, tree_keys, BATCH_TREE_SIZE);
+        key_workload_fill(&options.keys, &keys_prng, keys, BATCH_KEYS);
+        for (int run = 0; run < 2; run++) {
+            // one by one first on even repetitions, batches first on odd ones
+            int batched = (run + z) % 2;
+            arena_init(&arena, ARENA_SLAB_SIZE);
+            void *root = tree->search_and_insert(tree_keys, BATCH_TREE_SIZE, &arena);
+            w_start = clock_ns();
+            tree->insert(root, keys, BATCH_KEYS, batched ? batch : 0, &arena);
+            end = clock_ns();
+            (batched ? times : single_times)[z] = (double) BATCH_KEYS * 1e9 / (double) (end - w_start + 1);
+            // the arena holds every node of the tree
+            arena_free(&arena);
+        }
     }
-    /* first print data of node */
-    printf("%d:%s:%s ", node->key, node->data, color);
+    free(tree_keys);
+    free(keys);
 
-    /* then recur on left subtree */
-    rbt_show(node->left);
+    get_statistic(single_times, options.min_times, single, single_deviation);
+    get_statistic(times, options.min_times, throughput, deviation);
+    free(single_times);
+    free(times);
+}
 
-    /* now recur on right subtree */
-    rbt_show(node->right);
+/**
+ * Print keys per second inserted one by one and in batches of 1 to BATCH_MAX_SIZE keys
+ * One line per batch size: batch size, then for BST, AVL and RBT throughput
+ * one by one, S.D., throughput in batches, S.D.
+ */
+void batch_trees_time() {
+    const struct batch_bench *trees[] = { &bst_batch_bench, &avl_batch_bench, &rbt_batch_bench };
+
+    printf("# keys per second inserted in trees of %d keys, one by one and in batches\n", BATCH_TREE_SIZE);
+    for (int batch = 1; batch <= BATCH_MAX_SIZE; batch *= 2) {
+        printf("%d", batch);
+        for (int t = 0; t < 3; t++) {
+            double single;
+            double single_deviation;
+            double throughput;
+            double deviation;
+            batch_time(trees[t], batch, &single, &single_deviation, &throughput, &deviation);
+            printf(" %.3f %.3f %.3f %.3f", single, single_deviation, throughput, deviation);
+        }
+        printf("\n");
+    }
 }
 
+
+/***********************************
+ *  Range scans
+ ************************************/
+
+/* Range scan of a tree built once, out of the measure: it returns the number of keys visited */
+typedef long (*range_fn)(const void *tree, int low, int high);
+
 /**
- * Search and insert n keys in a Red-Black Tree
- * @param n number of keys to search and insert
- * @return RBT root node
+ * Scan the keys from low to high of a Binary Search Tree
+ * @param tree BST root node
+ * @param low lowest key
+ * @param high highest key
+ * @return number of keys in the range
  */
-struct rbt_node* rbt_search_and_insert(int n) {
-    struct rbt_node* root = T_Nil;
-    char result[2] = "";
-    int hit = 0;
-    int miss = 0;
+long bst_range(const void *tree, int low, int high) {
+    struct bst_iterator it;
+    struct bst_node *node;
+    long count = 0;
+
+    bst_iter_init(&it);
+    bst_iter_seek(&it, (struct bst_node *) tree, low);
+    while ((node = bst_iter_next(&it)) != NULL && node->key <= high)
+        count++;
+    bst_iter_free(&it);
+    return count;
+}
 
-    for (int i=0; i < n; i++) {
-        // In the GNU C Library the largest value the rand function can return is 2147483647.
-        int randomNumber;
-        randomNumber = rand();
-        if (root != T_Nil)
-            strcpy(result, rbt_find(root, randomNumber));
-        if ((strcmp(result, "d") != 0)) {
-            miss++;
-            root = rbt_insert(root, randomNumber, "d");
-        } else {
-            hit++;
+/**
+ * Scan the keys from low to high of an AVL
+ * @param tree AVL root node
+ * @param low lowest key
+ * @param high highest key
+ * @return number of keys in the range
+ */
+long avl_range(const void *tree, int low, int high) {
+    struct avl_iterator it;
+    struct avl_node *node;
+    long count = 0;
+
+    avl_iter_seek(&it, (struct avl_node *) tree, low);
+    while ((node = avl_iter_next(&it)) != NULL && node->key <= high)
+        count++;
+    return count;
+}
+
+/**
+ * Scan the keys from low to high of a Red-Black Tree
+ * @param tree RBT root node
+ * @param low lowest key
+ * @param high highest key
+ * @return number of keys in the range
+ */
+long rbt_range(const void *tree, int low, int high) {
+    struct rbt_iterator it;
+    struct rbt_node *node;
+    long count = 0;
+
+    rbt_iter_seek(&it, (struct rbt_node *) tree, low);
+    while ((node = rbt_iter_next(&it)) != NULL && node->key <= high)
+        count++;
+    return count;
+}
+
+/**
+ * Get time of range scans on a tree
+ * @param range range scan function of the tree
+ * @param tree tree to scan
+ * @param lows lowest key of each scan
+ * @param width highest key minus lowest key of every scan
+ * @param scans number of scans
+ * @param time average or median time of a scan
+ * @param deviation standard deviation or median absolute deviation
+ * @return average number of keys of a scan
+ */
+double range_time(range_fn range, const void *tree, const int *lows, long long width, int scans,
+                  double *time, double *deviation) {
+    long long start, end, w_start;
+    double *times = times_alloc();
+    long keys = 0;
+    ssize_t z = 0;
+
+    start = clock_ns();
+    do {
+        // Reset start time on every loop
+        w_start = clock_ns();
+        keys = 0;
+        for (int i = 0; i < scans; i++) {
+            int high = (lows[i] + width > INT_MAX) ? INT_MAX : (int) (lows[i] + width);
+            keys += range(tree, lows[i], high);
         }
+        end = clock_ns();
+        // Save time of a scan
+        times[z] = (double) (end - w_start) / 1e9 / (double) scans;
+        z++;
+    } while ((z < options.min_times || (double) (end - start) < ((double) resolution / options.error_max + (double) resolution))
+             && z < options.max_times);
+
+    get_statistic(times, z, time, deviation);
+    free(times);
+    return (double) keys / (double) scans;
+}
+
+/**
+ * Print time of range scans by selectivity on trees of RANGE_TREE_SIZE keys of the workload
+ * A scan of selectivity 2^-s covers 2^-s of the keys space. One line per
+ * selectivity: s, average number of keys of a scan, then for BST, AVL and RBT
+ * time of a scan and S.D. (NAN for a BST of sorted keys).
+ */
+void range_trees_time() {
+    const struct tree_bench *trees[] = { &bst_bench, &avl_bench, &rbt_bench };
+    range_fn ranges[] = { bst_range, avl_range, rbt_range };
+    void *roots[3];
+    int *lows = (int *) malloc(RANGE_MAX_SCANS * sizeof(int));
+    if (lows == NULL)
+    {
+        fprintf (stderr, "create keys array fail\n");
+        exit(1);
     }
-    //printf("hit: %d / miss: %d\n", hit, miss);
+
+    int *tree_keys = workload_keys(RANGE_TREE_SIZE);
+    // BST with sorted keys is a list, not measured
+    int first = key_workload_sorted(&options.keys) ? 1 : 0;
+    for (int t = first; t < 3; t++)
+        roots[t] = trees[t]->search_and_insert(tree_keys, RANGE_TREE_SIZE, NULL);
+    free(tree_keys);
+    printf("# range scans on trees of %d keys, by selectivity\n", RANGE_TREE_SIZE);
+    for (int s = RANGE_MIN_SELECTIVITY; s >= 0; s--) {
+        long long width = (long long) UINT32_MAX >> s;
+        // about the same number of keys visited for every selectivity
+        int scans = (1 << s < RANGE_MAX_SCANS) ? 1 << s : RANGE_MAX_SCANS;
+        for (int i = 0; i < scans; i++) {
+            // scans are centered on a random key of the whole keys space
+            long long low = (long long) (int) prng_u32(&keys_prng) - width / 2;
+            lows[i] = (low < INT_MIN) ? INT_MIN : (int) low;
+        }
+        double keys = 0;
+        double time[3] = { NAN, NAN, NAN };
+        double deviation[3] = { NAN, NAN, NAN };
+        for (int t = first; t < 3; t++)
+            keys = range_time(ranges[t], roots[t], lows, width, scans, &time[t], &deviation[t]);
+        printf("%d %.3f %.15f %.15f %.15f %.15f %.15f %.15f\n",
+               s, keys, time[0], deviation[0], time[1], deviation[1], time[2], deviation[2]);
+    }
+    for (int t = first; t < 3; t++)
+        trees[t]->clear(NULL, roots[t]);
+    free(lows);
+}
+
+
+/***********************************
+ *  Split and join
+ ************************************/
+
+/* Cut of a tree at a key and concatenation of the two parts, it returns the new root */
+typedef void* (*cut_fn)(void *tree, int key);
+
+/**
+ * Split an AVL at a key and concatenate the two AVLs again
+ * @param tree AVL root node
+ * @param key key to split at
+ * @return AVL root node
+ */
+void* avl_split_concat(void *tree, int key) {
+    struct avl_node *less;
+    struct avl_node *greater;
+    avl_split((struct avl_node *) tree, key, &less, &greater);
+    return avl_concat(less, greater);
+}
+
+/**
+ * Split an AVL at a key by linking again its nodes into two AVLs, then
+ * concatenate them the same way
+ * @param tree AVL root node
+ * @param key key to split at
+ * @return AVL root node
+ */
+void* avl_rebuild_cut(void *tree, int key) {
+    struct avl_node *root = (struct avl_node *) tree;
+    int n = avl_in_order(root, NULL);
+    struct avl_node **nodes = (struct avl_node **) malloc((n + 1) * sizeof(struct avl_node *));
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create nodes array fail\n");
+        exit(1);
+    }
+    avl_in_order(root, nodes);
+    int cut = 0;
+    while (cut < n && nodes[cut]->key < key)
+        cut++;
+    struct avl_node *less = avl_build(nodes, cut);
+    struct avl_node *greater = avl_build(nodes + cut, n - cut);
+    // concatenate: nodes of both trees in order, linked again
+    int less_n = avl_in_order(less, nodes);
+    avl_in_order(greater, nodes + less_n);
+    root = avl_build(nodes, n);
+    free(nodes);
     return root;
 }
 
 /**
- * Get time of "n" search-and-insert operations in a Red-Black Tree
- * @param n number of keys to search and insert
- * @param record data_point record
+ * Split a Red-Black Tree at a key and concatenate the two RBTs again
+ * @param tree RBT root node
+ * @param key key to split at
+ * @return RBT root node
  */
-void rbt_search_and_insert_time(int n, struct Records *record) {
-    clock_t start, end, w_start;
+void* rbt_split_concat(void *tree, int key) {
+    struct rbt_node *less;
+    struct rbt_node *greater;
+    rbt_split((struct rbt_node *) tree, key, &less, &greater);
+    return rbt_concat(less, greater);
+}
 
-    struct rbt_node* pt_clear_nodes[MAX_TIMES];
-    start = clock();
-    // Do the work.
-    double times[MAX_TIMES];
-    double times_sum = 0;
+/**
+ * Split a Red-Black Tree at a key by linking again its nodes into two RBTs,
+ * then concatenate them the same way
+ * @param tree RBT root node
+ * @param key key to split at
+ * @return RBT root node
+ */
+void* rbt_rebuild_cut(void *tree, int key) {
+    struct rbt_node *root = (struct rbt_node *) tree;
+    int n = rbt_in_order(root, NULL);
+    struct rbt_node **nodes = (struct rbt_node **) malloc((n + 1) * sizeof(struct rbt_node *));
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create nodes array fail\n");
+        exit(1);
+    }
+    rbt_in_order(root, nodes);
+    int cut = 0;
+    while (cut < n && nodes[cut]->key < key)
+        cut++;
+    struct rbt_node *less = rbt_build(nodes, cut);
+    struct rbt_node *greater = rbt_build(nodes + cut, n - cut);
+    // concatenate: nodes of both trees in order, linked again
+    int less_n = rbt_in_order(less, nodes);
+    rbt_in_order(greater, nodes + less_n);
+    root = rbt_build(nodes, n);
+    free(nodes);
+    return root;
+}
+
+/**
+ * Get time of cuts of a tree, each one at another random key
+ * @param cut split and concatenation function of the tree
+ * @param tree tree to cut, its root changes
+ * @param time average and median time of a cut, by statistic
+ * @param deviation standard deviation and median absolute deviation, by statistic
+ */
+void cut_time(cut_fn cut, void **tree, double time[], double deviation[]) {
+    long long start, end, w_start;
+    double *times = times_alloc();
+    int keys[SPLIT_CUTS];
     ssize_t z = 0;
+
+    start = clock_ns();
     do {
-        ssize_t k = 0;
-        do {
-            // Reset start time on every loop
-            w_start = clock();
-            // clearing the tree while taking times false the result, clear them at the end of the cycle
-            pt_clear_nodes[k+z] = rbt_search_and_insert(n);
-            end = clock();
-            // Save amortized time
-            times[k+z] = (double) (end - w_start) / CLOCKS_PER_SEC / (double) n;
-            if (USE_MEDIAN == 0)
-                times_sum += times[k]; // useful to calculate mean
-            k++;
-        } while ((double) (end - start) < ((double) resolution / ERROR_MAX + (double) resolution));
-        // clear rbt trees
-        for (int j = z; j < k+z; j++) {
-            rbt_clear(pt_clear_nodes[j]);
-            pt_clear_nodes[j] = T_Nil;
-        }
-        z = z+k;
-    } while (z < MIN_TIMES);
-    if (USE_MEDIAN == 1) {
-        double median = 0;
-        median = get_median(times, z);
-        double mad = 0;
-        mad = get_mad(times, z, median);
-        record->t3 = median;
-        record->d3 = mad;
+        for (int i = 0; i < SPLIT_CUTS; i++)
+            keys[i] = (int) prng_u32(&keys_prng);
+        // Reset start time on every loop
+        w_start = clock_ns();
+        for (int i = 0; i < SPLIT_CUTS; i++)
+            *tree = cut(*tree, keys[i]);
+        end = clock_ns();
+        // Save time of a cut
+        times[z] = (double) (end - w_start) / 1e9 / (double) SPLIT_CUTS;
+        z++;
+    } while ((z < options.min_times || (double) (end - start) < ((double) resolution / options.error_max + (double) resolution))
+             && z < options.max_times);
+
+    get_statistics(times, z, time, deviation);
+    free(times);
+}
+
+/**
+ * Get time of split and concatenation, and of the same cut by rebuilding,
+ * on an AVL and a RBT of the n keys of the workload (NAN for rebuilding big trees)
+ * @param n number of keys
+ * @param record data_point record: AVL split, AVL rebuild, RBT split and RBT rebuild times
+ */
+void split_trees_time(int n, struct Records *record) {
+    int *keys = workload_keys(n);
+    void *avl = avl_search_and_insert(keys, n, NULL);
+    void *rbt = rbt_search_and_insert(keys, n, NULL);
+    free(keys);
+
+    record->n = n;
+    cut_time(avl_split_concat, &avl, record->t1, record->d1);
+    cut_time(rbt_split_concat, &rbt, record->t3, record->d3);
+    if (n <= SPLIT_REBUILD_MAX_N) {
+        cut_time(avl_rebuild_cut, &avl, record->t2, record->d2);
+        cut_time(rbt_rebuild_cut, &rbt, record->t4, record->d4);
     } else {
-        // Average time
-        double mean;
-        mean = (double) times_sum / (double) (z);
-        // Standard deviation
-        double sd;
-        for (int i = 0; i < z; ++i) {
-            sd += pow(times[i] - mean, 2);
+        set_nan(record->t2, record->d2);
+        set_nan(record->t4, record->d4);
+    }
+
+    avl_free_nodes((struct avl_node *) avl);
+    rbt_free_nodes((struct rbt_node *) rbt);
+}
+
+
+/***********************************
+ *  Sharded map
+ ************************************/
+
+/* Work of a thread on a sharded map */
+struct shard_worker {
+    pthread_t thread;
+    struct shard_map *map;
+    int ops;            // keys to search and insert
+    const int *keys;    // keys of the thread, drawn from its own stream before the threads start
+};
+
+/**
+ * Search and insert the keys of a thread in a sharded map
+ * @param arg shard_worker
+ * @return NULL
+ */
+void* shard_worker_run(void *arg) {
+    struct shard_worker *worker = (struct shard_worker *) arg;
+    for (int i = 0; i < worker->ops; i++)
+        shard_map_search_and_insert(worker->map, worker->keys[i], "d");
+    return NULL;
+}
+
+/**
+ * Get wall clock time, threads run in parallel so CPU time would add their times
+ * @return seconds from an arbitrary point
+ */
+double wall_time() {
+    return (double) clock_ns() / 1e9;
+}
+
+/**
+ * Get throughput of threads searching and inserting SHARD_KEYS keys of the workload,
+ * in all, in an empty sharded map
+ * @param tree tree of the shards
+ * @param partition how keys are spread over the shards
+ * @param threads number of threads
+ * @param throughput average or median operations per second
+ * @param deviation standard deviation or median absolute deviation
+ */
+void shard_time(enum shardTree tree, enum shardPartition partition, int threads,
+                double *throughput, double *deviation) {
+    struct shard_worker *workers = (struct shard_worker *) malloc(threads * sizeof(struct shard_worker));
+    double times[SHARD_RUNS];
+    if (workers == NULL)
+    {
+        fprintf (stderr, "create workers fail\n");
+        exit(1);
+    }
+
+    for (int z = 0; z < SHARD_RUNS; z++) {
+        struct shard_map map;
+        int *keys = keys_alloc(SHARD_KEYS);
+        int first = 0;
+        shard_map_init(&map, SHARD_COUNT, tree, partition);
+        for (int t = 0; t < threads; t++) {
+            workers[t].map = &map;
+            // same total work for any number of threads
+            workers[t].ops = SHARD_KEYS / threads + (t < SHARD_KEYS % threads);
+            workers[t].keys = keys + first;
+            stream_keys(keys + first, workers[t].ops);
+            first += workers[t].ops;
+        }
+        double start = wall_time();
+        for (int t = 0; t < threads; t++) {
+            if (pthread_create(&workers[t].thread, NULL, shard_worker_run, &workers[t]) != 0)
+            {
+                fprintf (stderr, "create thread fail\n");
+                exit(1);
+            }
+        }
+        for (int t = 0; t < threads; t++)
+            pthread_join(workers[t].thread, NULL);
+        times[z] = (double) SHARD_KEYS / (wall_time() - start);
+        shard_map_free(&map);
+        free(keys);
+    }
+    free(workers);
+
+    get_statistic(times, SHARD_RUNS, throughput, deviation);
+}
+
+/**
+ * Print search-and-insert throughput of sharded maps from 1 thread to one thread per core
+ * One line per number of threads: threads, then operations per second and
+ * S.D. of AVL shards by range, AVL shards by hash, RBT shards by range, RBT shards by hash.
+ */
+void shard_maps_time() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1)
+        cores = 1;
+
+    printf("# search-and-insert of %d keys per second in maps of %d shards, %ld cores\n",
+           SHARD_KEYS, SHARD_COUNT, cores);
+    for (int threads = 1; threads <= cores; threads++) {
+        double throughput[4];
+        double deviation[4];
+        shard_time(SHARD_AVL, SHARD_RANGE, threads, &throughput[0], &deviation[0]);
+        shard_time(SHARD_AVL, SHARD_HASH, threads, &throughput[1], &deviation[1]);
+        shard_time(SHARD_RBT, SHARD_RANGE, threads, &throughput[2], &deviation[2]);
+        shard_time(SHARD_RBT, SHARD_HASH, threads, &throughput[3], &deviation[3]);
+        printf("%d", threads);
+        for (int i = 0; i < 4; i++)
+            printf(" %.3f %.3f", throughput[i], deviation[i]);
+        printf("\n");
+    }
+}
+
+
+/***********************************
+ *  Reads under concurrent inserts
+ ************************************/
+
+/* Tree shared by the readers and the writer of the reads measure */
+enum readsTree {
+    READS_COW,      // copy-on-write AVL, lookups take no lock
+    READS_LOCKED    // AVL behind a mutex (a sharded map of one shard)
+};
+
+/* Work of a reader or of the writer thread */
+struct reads_worker {
+    pthread_t thread;
+    enum readsTree tree;
+    struct cow_tree *cow;
+    struct shard_map *map;
+    int reader;         // reader slot in the copy-on-write AVL
+    int ops;            // keys to search, keys inserted for the writer
+    int found;          // keys found, so searches are not optimized out
+    int *stop;          // set when all readers are done, read by the writer
+    const int *keys;    // keys of the thread, drawn from its own stream before the threads start
+    int count;          // number of keys, the writer inserts them again when it is done
+};
+
+/**
+ * Search the keys of a reader in the shared tree
+ * @param arg reads_worker
+ * @return NULL
+ */
+void* reads_reader_run(void *arg) {
+    struct reads_worker *worker = (struct reads_worker *) arg;
+    char buf[MAX_LINE_SIZE];
+    for (int i = 0; i < worker->ops; i++) {
+        // keys of the searched space, whatever the workload
+        int key = (int) ((unsigned int) worker->keys[i] % (2 * READS_TREE_SIZE));
+        if (worker->tree == READS_COW) {
+            cow_read_begin(worker->cow, worker->reader);
+            worker->found += cow_find(worker->cow, key) != NULL;
+            cow_read_end(worker->cow, worker->reader);
+        } else {
+            worker->found += shard_map_find(worker->map, key, buf, sizeof(buf));
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Insert the keys of the writer in the shared tree until the readers are done
+ * @param arg reads_worker
+ * @return NULL
+ */
+void* reads_writer_run(void *arg) {
+    struct reads_worker *worker = (struct reads_worker *) arg;
+    worker->ops = 0;
+    while (!__atomic_load_n(worker->stop, __ATOMIC_ACQUIRE)) {
+        int key = worker->keys[worker->ops % worker->count];
+        if (worker->tree == READS_COW)
+            cow_insert(worker->cow, key, "d");
+        else
+            shard_map_insert(worker->map, key, "d");
+        worker->ops++;
+    }
+    return NULL;
+}
+
+/**
+ * Get throughput of reader threads searching READS_KEYS keys of the workload, in all,
+ * while one more thread inserts keys of the workload, in a tree of READS_TREE_SIZE keys
+ * @param tree tree shared by the threads
+ * @param readers number of reader threads
+ * @param reads average or median searches per second
+ * @param reads_deviation standard deviation or median absolute deviation of searches
+ * @param inserts average or median inserts per second of the writer
+ * @param inserts_deviation standard deviation or median absolute deviation of inserts
+ */
+void reads_time(enum readsTree tree, int readers, double *reads, double *reads_deviation,
+                double *inserts, double *inserts_deviation) {
+    struct reads_worker *workers = (struct reads_worker *) malloc((readers + 1) * sizeof(struct reads_worker));
+    double read_times[SHARD_RUNS];
+    double insert_times[SHARD_RUNS];
+    if (workers == NULL)
+    {
+        fprintf (stderr, "create workers fail\n");
+        exit(1);
+    }
+
+    for (int z = 0; z < SHARD_RUNS; z++) {
+        struct cow_tree cow;
+        struct shard_map map;
+        int stop = 0;
+        // keys of the readers, then of the writer
+        int *keys = keys_alloc(2 * READS_KEYS);
+        int first = 0;
+        if (tree == READS_COW)
+            cow_init(&cow);
+        else
+            shard_map_init(&map, 1, SHARD_AVL, SHARD_HASH);
+        // even keys of the searched space, half of the searches find their key
+        for (int i = 0; i < READS_TREE_SIZE; i++) {
+            if (tree == READS_COW)
+                cow_insert(&cow, 2 * i, "d");
+            else
+                shard_map_insert(&map, 2 * i, "d");
+        }
+        // workers[readers] is the writer
+        for (int t = 0; t <= readers; t++) {
+            workers[t].tree = tree;
+            workers[t].cow = &cow;
+            workers[t].map = &map;
+            workers[t].reader = (tree == READS_COW && t < readers) ? cow_reader_register(&cow) : 0;
+            // same total work for any number of readers
+            workers[t].ops = READS_KEYS / readers + (t < READS_KEYS % readers);
+            workers[t].found = 0;
+            workers[t].stop = &stop;
+            workers[t].keys = keys + first;
+            workers[t].count = t < readers ? workers[t].ops : READS_KEYS;
+            stream_keys(keys + first, workers[t].count);
+            first += workers[t].count;
+        }
+        double start = wall_time();
+        for (int t = 0; t <= readers; t++) {
+            if (pthread_create(&workers[t].thread, NULL, t < readers ? reads_reader_run : reads_writer_run,
+                               &workers[t]) != 0)
+            {
+                fprintf (stderr, "create thread fail\n");
+                exit(1);
+            }
+        }
+        for (int t = 0; t < readers; t++)
+            pthread_join(workers[t].thread, NULL);
+        double elapsed = wall_time() - start;
+        __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+        pthread_join(workers[readers].thread, NULL);
+        read_times[z] = (double) READS_KEYS / elapsed;
+        insert_times[z] = (double) workers[readers].ops / elapsed;
+        if (tree == READS_COW)
+            cow_free(&cow);
+        else
+            shard_map_free(&map);
+        free(keys);
+    }
+    free(workers);
+
+    get_statistic(read_times, SHARD_RUNS, reads, reads_deviation);
+    get_statistic(insert_times, SHARD_RUNS, inserts, inserts_deviation);
+}
+
+/**
+ * Print search throughput under one inserting thread from 1 reader thread to one per core
+ * One line per number of readers: readers, then searches per second and S.D.,
+ * inserts per second and S.D. of the copy-on-write AVL, then of the AVL behind a mutex.
+ */
+void reads_trees_time() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1)
+        cores = 1;
+
+    printf("# searches of %d keys per second in trees of %d keys under one inserting thread, %ld cores\n",
+           READS_KEYS, READS_TREE_SIZE, cores);
+    for (int readers = 1; readers <= cores; readers++) {
+        double throughput[4];
+        double deviation[4];
+        reads_time(READS_COW, readers, &throughput[0], &deviation[0], &throughput[1], &deviation[1]);
+        reads_time(READS_LOCKED, readers, &throughput[2], &deviation[2], &throughput[3], &deviation[3]);
+        printf("%d", readers);
+        for (int i = 0; i < 4; i++)
+            printf(" %.3f %.3f", throughput[i], deviation[i]);
+        printf("\n");
+    }
+}
+
+
+/***********************************
+ *  Reader-writer lock
+ ************************************/
+
+/* Work of a reader or writer thread on a tree behind a read-write lock */
+struct rw_worker {
+    pthread_t thread;
+    struct rw_tree *tree;
+    pthread_barrier_t *start;   // threads start together
+    int writer;                 // 1 to insert keys, 0 to find them
+    int found;                  // keys found, so finds are not optimized out
+    const int *keys;            // RW_OPS keys of the thread, drawn from its own stream before the threads start
+    double *latencies;          // nanoseconds of each operation
+    double elapsed;             // seconds of all operations
+};
+
+/**
+ * Find or insert the RW_OPS keys of a thread, timing each operation
+ * @param arg rw_worker
+ * @return NULL
+ */
+void* rw_worker_run(void *arg) {
+    struct rw_worker *worker = (struct rw_worker *) arg;
+    char buf[MAX_LINE_SIZE];
+    pthread_barrier_wait(worker->start);
+    double start = wall_time();
+    for (int i = 0; i < RW_OPS; i++) {
+        double begin = wall_time();
+        if (worker->writer)
+            rw_tree_insert(worker->tree, worker->keys[i], "d");
+        else
+            // keys of the searched space, whatever the workload
+            worker->found += rw_tree_find(worker->tree, (int) ((unsigned int) worker->keys[i] % (2 * RW_TREE_SIZE)),
+                                          buf, sizeof(buf));
+        worker->latencies[i] = (wall_time() - begin) * 1e9;
+    }
+    worker->elapsed = wall_time() - start;
+    return NULL;
+}
+
+/**
+ * Compare two latencies, for qsort: latencies have many ties, quickSort would be quadratic
+ * @param a first latency
+ * @param b second latency
+ * @return negative, zero or positive as a is less, equal or greater than b
+ */
+int compare_latency(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Print throughput and latency of every thread of readers and writers sharing a tree
+ * The tree holds RW_TREE_SIZE shuffled even keys, half of the finds hit.
+ * @param kind tree behind the lock
+ * @param policy who gets the lock first
+ * @param readers number of reader threads
+ * @param writers number of writer threads
+ */
+void rw_time(enum rwTree kind, enum rwPolicy policy, int readers, int writers) {
+    static const char *tree_names[] = {"BST", "AVL", "RBT"};
+    static const char *policy_names[] = {"readers", "writers"};
+    int threads = readers + writers;
+    struct rw_worker *workers = (struct rw_worker *) malloc(threads * sizeof(struct rw_worker));
+    int *keys = (int *) malloc(RW_TREE_SIZE * sizeof(int));
+    if (workers == NULL || keys == NULL)
+    {
+        fprintf (stderr, "create workers fail\n");
+        exit(1);
+    }
+
+    struct rw_tree tree;
+    rw_tree_init(&tree, kind, policy);
+    // shuffled, so that the BST is not a list
+    for (int i = 0; i < RW_TREE_SIZE; i++)
+        keys[i] = 2 * i;
+    for (int i = RW_TREE_SIZE - 1; i > 0; i--) {
+        int j = (int) prng_below(&keys_prng, (uint32_t) i + 1);
+        int key = keys[i];
+        keys[i] = keys[j];
+        keys[j] = key;
+    }
+    for (int i = 0; i < RW_TREE_SIZE; i++)
+        rw_tree_insert(&tree, keys[i], "d");
+    int *ops_keys = keys_alloc(threads * RW_OPS);
+
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads);
+    for (int t = 0; t < threads; t++) {
+        workers[t].tree = &tree;
+        workers[t].start = &start;
+        workers[t].writer = t >= readers;
+        workers[t].found = 0;
+        workers[t].keys = ops_keys + (size_t) t * RW_OPS;
+        stream_keys(ops_keys + (size_t) t * RW_OPS, RW_OPS);
+        workers[t].latencies = (double *) malloc(RW_OPS * sizeof(double));
+        if (workers[t].latencies == NULL)
+        {
+            fprintf (stderr, "create workers fail\n");
+            exit(1);
+        }
+        if (pthread_create(&workers[t].thread, NULL, rw_worker_run, &workers[t]) != 0)
+        {
+            fprintf (stderr, "create thread fail\n");
+            exit(1);
         }
-        sd = sqrt(sd / z);
-        record->t3 = mean;
-        record->d3 = sd;
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_join(workers[t].thread, NULL);
+
+    for (int t = 0; t < threads; t++) {
+        qsort(workers[t].latencies, RW_OPS, sizeof(double), compare_latency);
+        printf("%s %s %s %d %.3f %.1f %.1f\n", tree_names[kind], policy_names[policy],
+               workers[t].writer ? "insert" : "find", t, (double) RW_OPS / workers[t].elapsed,
+               workers[t].latencies[RW_OPS / 2], workers[t].latencies[(int) (RW_OPS * 0.99)]);
+        free(workers[t].latencies);
+    }
+    pthread_barrier_destroy(&start);
+    rw_tree_free(&tree);
+    free(ops_keys);
+    free(keys);
+    free(workers);
+}
+
+/**
+ * Print throughput and latency of reader and writer threads sharing BST, AVL and RBT
+ * behind a read-write lock preferring readers, then one preferring writers
+ * One line per thread: tree, preferred threads, operation, thread, operations per second,
+ * p50 and p99 latency in nanoseconds. Writers insert sorted keys in a BST as in a list,
+ * BST is not measured with sorted keys.
+ * @param readers number of reader threads
+ * @param writers number of writer threads
+ */
+void rw_trees_time(int readers, int writers) {
+    printf("# %d finds per reader, %d inserts per writer, %d readers, %d writers, trees of %d keys\n",
+           RW_OPS, RW_OPS, readers, writers, RW_TREE_SIZE);
+    int first = (key_workload_sorted(&options.keys) && writers > 0) ? RW_AVL : RW_BST;
+    for (int kind = first; kind <= RW_RBT; kind++) {
+        rw_time((enum rwTree) kind, RW_PREFER_READERS, readers, writers);
+        rw_time((enum rwTree) kind, RW_PREFER_WRITERS, readers, writers);
     }
 }
 
 
+/***********************************
+ *  Chart lines
+ ************************************/
+
+/* Columns of a chart line, each one by statistic */
+struct chart_line {
+    int n;                                          // number of operations, first column
+    int count;                                      // number of columns after n
+    double values[CHART_MAX_COLUMNS][STATISTICS];
+    int precision[CHART_MAX_COLUMNS];               // digits after the decimal point
+};
+
+/* Outputs of the chart lines of each statistic, NULL if not written */
+FILE *chart_outputs[STATISTICS];
+
+/**
+ * Add a column to a chart line
+ * @param line chart line
+ * @param value value of the column, by statistic
+ * @param precision digits after the decimal point
+ */
+void line_add(struct chart_line *line, const double value[], int precision) {
+    if (line->count == CHART_MAX_COLUMNS)
+    {
+        fprintf (stderr, "chart line columns fail\n");
+        exit(1);
+    }
+    for (int statistic = 0; statistic < STATISTICS; statistic++)
+        line->values[line->count][statistic] = value[statistic];
+    line->precision[line->count++] = precision;
+}
+
+/**
+ * Add a column with the same value for every statistic to a chart line
+ * @param line chart line
+ * @param value value of the column
+ * @param precision digits after the decimal point
+ */
+void line_add_value(struct chart_line *line, double value, int precision) {
+    double values[STATISTICS];
+    for (int statistic = 0; statistic < STATISTICS; statistic++)
+        values[statistic] = value;
+    line_add(line, values, precision);
+}
+
+/**
+ * Add time and deviation of the first trees of a record to a chart line
+ * @param line chart line
+ * @param record data point record
+ * @param trees number of trees: 3 for t1 to t3, 4 for t1 to t4
+ */
+void line_add_records(struct chart_line *line, const struct Records *record, int trees) {
+    const double *times[] = { record->t1, record->t2, record->t3, record->t4 };
+    const double *deviations[] = { record->d1, record->d2, record->d3, record->d4 };
+    for (int t = 0; t < trees; t++) {
+        line_add(line, times[t], 15);
+        line_add(line, deviations[t], 15);
+    }
+}
+
+/**
+ * Write a chart line to every chart output, each one with its statistic
+ * @param line chart line
+ */
+void chart_print(const struct chart_line *line) {
+    char separator = (options.format == CSV) ? ',' : ' ';
+    for (int statistic = 0; statistic < STATISTICS; statistic++) {
+        FILE *out = chart_outputs[statistic];
+        if (out == NULL)
+            continue;
+        fprintf(out, "%d", line->n);
+        for (int i = 0; i < line->count; i++)
+            fprintf(out, "%c%.*f", separator, line->precision[i], line->values[i][statistic]);
+        fprintf(out, "\n");
+    }
+}
+
+/**
+ * Write a comment line to every chart output, gnuplot skips lines starting with #
+ * CSV outputs get no comments.
+ * @param format printf format of the comment, after "# "
+ */
+void chart_comment(const char *format, ...) {
+    if (options.format == CSV)
+        return;
+    for (int statistic = 0; statistic < STATISTICS; statistic++) {
+        FILE *out = chart_outputs[statistic];
+        if (out == NULL)
+            continue;
+        va_list args;
+        va_start(args, format);
+        fprintf(out, "# ");
+        vfprintf(out, format, args);
+        fprintf(out, "\n");
+        va_end(args);
+    }
+}
+
+
+/***********************************
+ *  Chart jobs
+ ************************************/
+
+/**
+ * Fork the processes measuring the chart data points
+ * Job j measures data points j, j + jobs, j + 2 jobs... so that every job gets
+ * small and big trees, and writes their lines to its pipe, one line for each chart
+ * output. Jobs are processes, not threads: CPU time is per process, so the cpu
+ * argument times only the work of its job. Keys of data point i come from stream i
+ * of the seed, whatever the job. Job j is pinned to core j modulo the cores, more
+ * jobs than cores share cores and distort the times.
+ * @param jobs number of processes
+ * @param results read end of the pipe of each job, set in the parent
+ * @return job number in a child process, -1 in the parent
+ */
+int chart_jobs_fork(int jobs, FILE *results[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1)
+        cores = 1;
+    // lines still in the buffers would be written again by every child
+    fflush(NULL);
+    for (int job = 0; job < jobs; job++) {
+        int fd[2];
+        if (pipe(fd) != 0)
+        {
+            fprintf (stderr, "create chart job fail\n");
+            exit(1);
+        }
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            fprintf (stderr, "create chart job fail\n");
+            exit(1);
+        }
+        if (pid == 0) {
+            for (int j = 0; j < job; j++)
+                fclose(results[j]);
+            close(fd[0]);
+            dup2(fd[1], STDOUT_FILENO);
+            close(fd[1]);
+#ifdef __linux__
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(job % cores, &cpus);
+            sched_setaffinity(0, sizeof(cpus), &cpus);
+#endif
+            // every output of the parent is the pipe
+            for (int statistic = 0; statistic < STATISTICS; statistic++)
+                if (chart_outputs[statistic] != NULL)
+                    chart_outputs[statistic] = stdout;
+            return job;
+        }
+        close(fd[1]);
+        results[job] = fdopen(fd[0], "r");
+        if (results[job] == NULL)
+        {
+            fprintf (stderr, "create chart job fail\n");
+            exit(1);
+        }
+    }
+    return -1;
+}
+
+/**
+ * Write the lines of the chart jobs to the chart outputs in data point order, then wait for the jobs
+ * @param jobs number of processes
+ * @param results read end of the pipe of each job
+ * @return 0 if every job printed all its data points, 1 otherwise
+ */
+int chart_jobs_collect(int jobs, FILE *results[]) {
+    char *line = NULL;
+    size_t capacity = 0;
+    int failed = 0;
+    for (int i = 0; i < options.points && !failed; i++) {
+        for (int statistic = 0; statistic < STATISTICS && !failed; statistic++) {
+            if (chart_outputs[statistic] == NULL)
+                continue;
+            if (getline(&line, &capacity, results[i % jobs]) < 0)
+                failed = 1;
+            else
+                fputs(line, chart_outputs[statistic]);
+            // lines leave as soon as they are in order, so a long run shows progress
+            fflush(chart_outputs[statistic]);
+        }
+    }
+    free(line);
+    for (int job = 0; job < jobs; job++)
+        fclose(results[job]);
+    for (int job = 0; job < jobs; job++) {
+        int status;
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = 1;
+    }
+    if (failed)
+        fprintf (stderr, "chart job fail\n");
+    return failed;
+}
+
+
 /***********************************
  *  Main code
  ************************************/
 
-int main (void) {
-    // Initializes random number generator
-    time_t t;
-    srand((unsigned) time(&t));
 
-    // Initialize global variables
-    T_Nil = (struct rbt_node *) malloc(sizeof(rbt_node));
+/**
+ * Print the command line usage
+ * @param program name of the program
+ */
+void usage(const char *program) {
+    printf("Usage: %s [options] [mode...]\n"
+           "Options:\n"
+           "  -n, --min-n N          minimum number of operations (%d)\n"
+           "  -N, --max-n N          maximum number of operations (%d)\n"
+           "  -p, --points N         number of points to plot on chart (%d)\n"
+           "  -e, --error E          maximum relative error (%g)\n"
+           "  -m, --min-times N      minimum number of iterations of a measure (%d)\n"
+           "  -M, --max-times N      maximum number of iterations of a measure (%d)\n"
+           "  -s, --statistic S      mean or median, of standard output and of the tables (%s)\n"
+           "  -t, --trees LIST       trees of the chart, comma separated: bst,avl,rbt,btree (all)\n"
+           "  -f, --format F         text or csv chart lines (text)\n"
+           "  -w, --workload W       keys of every measure: uniform, sequential, reverse, nearly[:FRACTION],\n"
+           "                         zipf[:S], hotset[:FRACTION[:SHARE]] or trace:FILE (uniform)\n"
+           "      --seed N           seed of the random keys (the time)\n"
+           "      --mean-output F    write the mean/standard deviation chart to file F\n"
+           "      --median-output F  write the median/median absolute deviation chart to file F\n"
+           "  -h, --help             print this help\n"
+           "Chart modes: delete arena layout packed freeze load split cpu perf jobs [N]\n"
+           "Table modes: batch range threads reads rwlock [readers] [writers]\n",
+           program, MIN_N_LENGTH, MAX_N_LENGTH, CHART_DATA_POINTS, ERROR_MAX, MIN_TIMES, MAX_TIMES,
+           USE_MEDIAN ? "median" : "mean");
+}
+
+/**
+ * Parse a positive integer option value, exit on invalid values
+ * @param name name of the option
+ * @param value text of the value
+ * @return value
+ */
+int parse_int(const char *name, const char *value) {
+    char *end;
+    long number = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || number < 1 || number > INT_MAX)
+    {
+        fprintf (stderr, "invalid %s: %s\n", name, value);
+        exit(1);
+    }
+    return (int) number;
+}
+
+/**
+ * Parse the statistic of an option value, exit on invalid values
+ * @param value mean or median
+ * @return statistic
+ */
+enum statistic parse_statistic(const char *value) {
+    if (strcmp(value, "mean") == 0)
+        return MEAN;
+    if (strcmp(value, "median") == 0)
+        return MEDIAN;
+    fprintf (stderr, "invalid statistic: %s\n", value);
+    exit(1);
+}
+
+/**
+ * Parse the trees of an option value, exit on invalid values
+ * @param value comma separated list of bst, avl, rbt and btree
+ * @return chartTree bits of the trees
+ */
+unsigned int parse_trees(const char *value) {
+    const char *names[] = { "bst", "avl", "rbt", "btree" };
+    unsigned int trees = 0;
+    const char *name = value;
+    while (*name != '\0') {
+        size_t length = strcspn(name, ",");
+        int t;
+        for (t = 0; t < 4; t++)
+            if (strlen(names[t]) == length && strncmp(name, names[t], length) == 0)
+                break;
+        if (t == 4)
+        {
+            fprintf (stderr, "invalid trees: %s\n", value);
+            exit(1);
+        }
+        trees |= 1u << t;
+        name += length;
+        if (*name == ',')
+            name++;
+    }
+    if (trees == 0)
+    {
+        fprintf (stderr, "invalid trees: %s\n", value);
+        exit(1);
+    }
+    return trees;
+}
+
+/**
+ * Open the output of a statistic, exit on failure
+ * @param statistic statistic written to the file
+ * @param path file path
+ */
+void open_output(enum statistic statistic, const char *path) {
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf (stderr, "open %s fail\n", path);
+        exit(1);
+    }
+    chart_outputs[statistic] = out;
+}
+
+int main (int argc, char *argv[]) {
+    int compare_arena = 0;
+    int compare_layout = 0;
+    int compare_packed = 0;
+    int compare_frozen = 0;
+    int compare_load = 0;
+    int compare_split = 0;
+    int compare_batch = 0;
+    int compare_range = 0;
+    int compare_threads = 0;
+    int compare_reads = 0;
+    int compare_rw = 0;
+    int rw_readers = RW_READERS;
+    int rw_writers = RW_WRITERS;
+    int jobs = 1;
+    int compare_cpu = 0;
+    int compare_perf = 0;
+    int seed_given = 0;
+    const char *mean_output = NULL;
+    const char *median_output = NULL;
+    const char *key_workload = "uniform";
+    enum workload workload = SEARCH_AND_INSERT;
+
+    enum { OPT_SEED = 256, OPT_MEAN_OUTPUT, OPT_MEDIAN_OUTPUT };
+    static const struct option long_options[] = {
+        { "min-n",         required_argument, NULL, 'n' },
+        { "max-n",         required_argument, NULL, 'N' },
+        { "points",        required_argument, NULL, 'p' },
+        { "error",         required_argument, NULL, 'e' },
+        { "min-times",     required_argument, NULL, 'm' },
+        { "max-times",     required_argument, NULL, 'M' },
+        { "statistic",     required_argument, NULL, 's' },
+        { "trees",         required_argument, NULL, 't' },
+        { "format",        required_argument, NULL, 'f' },
+        { "workload",      required_argument, NULL, 'w' },
+        { "seed",          required_argument, NULL, OPT_SEED },
+        { "mean-output",   required_argument, NULL, OPT_MEAN_OUTPUT },
+        { "median-output", required_argument, NULL, OPT_MEDIAN_OUTPUT },
+        { "help",          no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int option;
+    char *end;
+    while ((option = getopt_long(argc, argv, "n:N:p:e:m:M:s:t:f:w:h", long_options, NULL)) != -1) {
+        switch (option) {
+            case 'n':
+                options.min_n = parse_int("min-n", optarg);
+                break;
+            case 'N':
+                options.max_n = parse_int("max-n", optarg);
+                break;
+            case 'p':
+                options.points = parse_int("points", optarg);
+                break;
+            case 'e':
+                options.error_max = strtod(optarg, &end);
+                if (*optarg == '\0' || *end != '\0' || !(options.error_max > 0)) {
+                    fprintf(stderr, "invalid error: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'm':
+                options.min_times = parse_int("min-times", optarg);
+                break;
+            case 'M':
+                options.max_times = parse_int("max-times", optarg);
+                break;
+            case 's':
+                options.statistic = parse_statistic(optarg);
+                break;
+            case 't':
+                options.trees = parse_trees(optarg);
+                break;
+            case 'f':
+                if (strcmp(optarg, "text") == 0)
+                    options.format = TEXT;
+                else if (strcmp(optarg, "csv") == 0)
+                    options.format = CSV;
+                else {
+                    fprintf(stderr, "invalid format: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'w':
+                if (!key_workload_parse(&options.keys, optarg)) {
+                    fprintf(stderr, "invalid workload: %s\n", optarg);
+                    return 1;
+                }
+                key_workload = optarg;
+                break;
+            case OPT_SEED:
+                options.seed = strtoull(optarg, &end, 10);
+                if (!isdigit((unsigned char) *optarg) || *end != '\0') {
+                    fprintf(stderr, "invalid seed: %s\n", optarg);
+                    return 1;
+                }
+                seed_given = 1;
+                break;
+            case OPT_MEAN_OUTPUT:
+                mean_output = optarg;
+                break;
+            case OPT_MEDIAN_OUTPUT:
+                median_output = optarg;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (options.min_n > options.max_n) {
+        fprintf(stderr, "min-n is bigger than max-n\n");
+        return 1;
+    }
+    if (options.min_times > options.max_times) {
+        fprintf(stderr, "min-times is bigger than max-times\n");
+        return 1;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        // "arena" argument adds the same measures with nodes allocated from arenas
+        if (strcmp(argv[i], "arena") == 0)
+            compare_arena = 1;
+        // "delete" argument measures insert-and-delete instead of search-and-insert
+        else if (strcmp(argv[i], "delete") == 0)
+            workload = INSERT_AND_DELETE;
+        // "layout" argument adds the same measures with nodes in a pool, linked by 32-bit indices
+        else if (strcmp(argv[i], "layout") == 0)
+            compare_layout = 1;
+        // "packed" argument adds the RBT with the color in the parent pointer
+        else if (strcmp(argv[i], "packed") == 0)
+            compare_packed = 1;
+        // "freeze" argument adds find times of AVL, RBT and frozen trees
+        else if (strcmp(argv[i], "freeze") == 0)
+            compare_frozen = 1;
+        // "load" argument adds times of one by one insert and bulk load of sorted keys
+        else if (strcmp(argv[i], "load") == 0)
+            compare_load = 1;
+        // "split" argument adds times of split and concatenation of AVL and RBT, and of the same cut by rebuilding
+        else if (strcmp(argv[i], "split") == 0)
+            compare_split = 1;
+        // "batch" argument measures insert throughput by batch size, instead of the chart
+        else if (strcmp(argv[i], "batch") == 0)
+            compare_batch = 1;
+        // "range" argument measures range scans by selectivity, instead of the chart
+        else if (strcmp(argv[i], "range") == 0)
+            compare_range = 1;
+        // "threads" argument measures sharded maps from 1 thread to all cores, instead of the chart
+        else if (strcmp(argv[i], "threads") == 0)
+            compare_threads = 1;
+        // "reads" argument measures lock-free searches under concurrent inserts, instead of the chart
+        else if (strcmp(argv[i], "reads") == 0)
+            compare_reads = 1;
+        // "rwlock [readers] [writers]" argument measures threads sharing trees behind a read-write lock, instead of the chart
+        else if (strcmp(argv[i], "rwlock") == 0) {
+            compare_rw = 1;
+            if (i + 1 < argc && isdigit((unsigned char) argv[i + 1][0]))
+                rw_readers = atoi(argv[++i]);
+            if (i + 1 < argc && isdigit((unsigned char) argv[i + 1][0]))
+                rw_writers = atoi(argv[++i]);
+            if (rw_readers + rw_writers < 1) {
+                fprintf(stderr, "rwlock needs at least one thread\n");
+                return 1;
+            }
+        }
+        // "cpu" argument adds the CPU time of the same runs, next to their wall time
+        else if (strcmp(argv[i], "cpu") == 0)
+            compare_cpu = 1;
+        // "perf" argument adds hardware counters per operation of the same runs (Linux only)
+        else if (strcmp(argv[i], "perf") == 0)
+            compare_perf = 1;
+        // "jobs [N]" argument measures chart data points in N processes (one per core by default), pinned to cores
+        else if (strcmp(argv[i], "jobs") == 0) {
+            jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+            if (i + 1 < argc && isdigit((unsigned char) argv[i + 1][0]))
+                jobs = atoi(argv[++i]);
+            if (jobs < 1)
+                jobs = 1;
+        }
+        else {
+            fprintf(stderr, "unknown mode: %s\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (jobs > options.points)
+        jobs = options.points;
+    if (compare_layout && workload == INSERT_AND_DELETE) {
+        fprintf(stderr, "delete workload is not available on the index layout\n");
+        return 1;
+    }
+    if (compare_packed && workload == INSERT_AND_DELETE) {
+        fprintf(stderr, "delete workload is not available on the packed RBT\n");
+        return 1;
+    }
+
+    // Initializes random number generator, runs with the same seed and options draw the same keys
+    if (!seed_given) {
+        time_t t;
+        options.seed = (unsigned long long) time(&t);
+    }
+    prng_seed(&keys_prng, options.seed);
 
     // Get b parameter needed to calculate number of iterations based on position on x-axis
-    b = (double) exp(((double) log(MAX_N_LENGTH) - (double) log(MIN_N_LENGTH)) / (CHART_DATA_POINTS - 1));
+    if (options.points > 1)
+        b = (double) exp(((double) log(options.max_n) - (double) log(options.min_n)) / (options.points - 1));
+    else
+        b = 1;
 
-    /* Get CPU clock resolution */
+    /* Get resolution of the clock of the measures */
     resolution = getResolution();
 
-    struct Records data_points[CHART_DATA_POINTS];
+    if (compare_batch) {
+        batch_trees_time();
+        return 0;
+    }
+    if (compare_range) {
+        range_trees_time();
+        return 0;
+    }
+    if (compare_threads) {
+        shard_maps_time();
+        return 0;
+    }
+    if (compare_reads) {
+        reads_trees_time();
+        return 0;
+    }
+    if (compare_rw) {
+        rw_trees_time(rw_readers, rw_writers);
+        return 0;
+    }
+
+    // Standard output gets the chart of the statistic option, unless it goes to a file
+    chart_outputs[options.statistic] = stdout;
+    if (mean_output != NULL)
+        open_output(MEAN, mean_output);
+    if (median_output != NULL)
+        open_output(MEDIAN, median_output);
+
+    chart_comment("seed %llu, %s keys", options.seed, key_workload);
+    if (compare_layout) {
+        // gnuplot skips lines starting with #
+        chart_comment("bytes per node (pointer/index layout): BST %zu/%zu AVL %zu/%zu RBT %zu/%zu",
+                      sizeof(bst_node), sizeof(ix_node),
+                      sizeof(avl_node), sizeof(ix_node),
+                      sizeof(rbt_node), sizeof(ix_node));
+    }
+    if (compare_packed) {
+        chart_comment("bytes per node (color field/packed color): RBT %zu/%zu",
+                      sizeof(rbt_node), sizeof(rbtp_node));
+    }
+
+    if (compare_perf) {
+        perf_counters_open(&perf);
+        int available = 0;
+        char names[256] = "";
+        for (int c = 0; c < PERF_COUNTERS; c++) {
+            size_t used = strlen(names);
+            snprintf(names + used, sizeof(names) - used, " %s%s", perf_counters_name((enum perfCounter) c),
+                     perf_counters_available(&perf, (enum perfCounter) c) ? "" : " (unavailable)");
+            available += perf_counters_available(&perf, (enum perfCounter) c);
+        }
+        chart_comment("hardware counters per operation of BST, AVL, RBT and B-tree:%s", names);
+        if (available == 0)
+            fprintf(stderr, "hardware counters not permitted or not supported, check /proc/sys/kernel/perf_event_paranoid\n");
+        // counters count the thread that opens them: each chart job opens its own
+        perf_counters_close(&perf);
+    }
+
+    // With jobs, this process measures data points job, job + jobs... and the parent prints them in order
+    int job = 0;
+    if (jobs > 1) {
+        FILE **results = (FILE **) malloc(options.points * sizeof(FILE *));
+        if (results == NULL)
+        {
+            fprintf (stderr, "create jobs array fail\n");
+            exit(1);
+        }
+        job = chart_jobs_fork(jobs, results);
+        if (job < 0) {
+            int status = chart_jobs_collect(jobs, results);
+            free(results);
+            return status;
+        }
+        free(results);
+    }
+
+    if (compare_perf)
+        perf_counters_open(&perf);
+
+    // keys of data point i come from stream i of the seed, the same with or without jobs
+    struct prng point_stream;
+    prng_stream(&point_stream, options.seed, job);
 
     // Do the work.
-    for (ssize_t i = 0; i < CHART_DATA_POINTS; i++) {
+    for (ssize_t i = job; i < options.points; i += jobs) {
+        struct Records data_point, arena_point, layout_point, packed_point, frozen_point;
+        struct Records sorted_point, load_point, split_point, cpu_point;
+        struct Counters counter_point;
+        struct chart_line line;
+        keys_prng = point_stream;
+        for (int j = 0; j < jobs; j++)
+            prng_jump(&point_stream);
         // Get number of iterations
         int iterations;
         iterations = get_iterations_number(i);
-        data_points[i].n = iterations;
-        // Get time of search-and-insert in a BST
-        bst_search_and_insert_time(iterations, &data_points[i]);
-        // Get time of search-and-insert in an AVL Tree
-        avl_search_and_insert_time(iterations, &data_points[i]);
-        // Get time of search-and-insert in a Red-Black Tree
-        rbt_search_and_insert_time(iterations, &data_points[i]);
-        // n iterations,time BST, S.D, BST, time AVL, SD AVL, time RBT, S.D. RBT
-        printf("%d %.15f %.15f %.15f %.15f %.15f %.15f\n",
-               data_points[i].n,
-               data_points[i].t1,
-               data_points[i].d1,
-               data_points[i].t2,
-               data_points[i].d2,
-               data_points[i].t3,
-               data_points[i].d3);
-
+        line.n = iterations;
+        line.count = 0;
+        // Get time of BST, AVL, RBT and B-tree
+        trees_time(pointer_layout, iterations, 0, workload, &data_point,
+                   compare_cpu ? &cpu_point : NULL, compare_perf ? &counter_point : NULL);
+        // n iterations,time BST, S.D, BST, time AVL, SD AVL, time RBT, S.D. RBT, time B-tree, S.D. B-tree
+        line_add_records(&line, &data_point, 4);
+        if (compare_arena) {
+            // Same measures with nodes allocated from arenas
+            trees_time(pointer_layout, iterations, 1, workload, &arena_point, NULL, NULL);
+            // time BST, S.D. BST, time AVL, S.D. AVL, time RBT, S.D. RBT, time B-tree, S.D. B-tree (arena)
+            line_add_records(&line, &arena_point, 4);
+        }
+        if (compare_layout) {
+            // Same measures with nodes in a pool, linked by 32-bit indices
+            trees_time(index_layout, iterations, 0, workload, &layout_point, NULL, NULL);
+            // time BST, S.D. BST, time AVL, S.D. AVL, time RBT, S.D. RBT (index layout)
+            line_add_records(&line, &layout_point, 3);
+        }
+        if (compare_packed) {
+            // Same RBT measure with the color packed in the parent pointer
+            packed_point.n = iterations;
+            tree_time(&rbtp_bench, iterations, 0, workload, packed_point.t3, packed_point.d3,
+                      NULL, NULL, NULL);
+            // time RBT, S.D. RBT (packed color)
+            line_add(&line, packed_point.t3, 15);
+            line_add(&line, packed_point.d3, 15);
         }
-    free(T_Nil);
+        if (compare_frozen) {
+            // Find times on trees of n keys
+            frozen_trees_time(iterations, &frozen_point);
+            // find time AVL, S.D. AVL, time RBT, S.D. RBT, time Eytzinger, S.D. Eytzinger, time vEB, S.D. vEB
+            line_add_records(&line, &frozen_point, 4);
+        }
+        if (compare_load) {
+            // Sorted keys inserted one by one and bulk loaded
+            sorted_point.n = iterations;
+            selected_tree_time(load_trees, 0, iterations, 0, SORTED_INSERT, sorted_point.t1, sorted_point.d1,
+                               NULL, NULL, NULL);
+            selected_tree_time(load_trees, 1, iterations, 0, SORTED_INSERT, sorted_point.t2, sorted_point.d2,
+                               NULL, NULL, NULL);
+            selected_tree_time(load_trees, 2, iterations, 0, SORTED_INSERT, sorted_point.t3, sorted_point.d3,
+                               NULL, NULL, NULL);
+            trees_time(load_trees, iterations, 0, SORTED_LOAD, &load_point, NULL, NULL);
+            // for BST, AVL and RBT: insert time, S.D., load time, S.D., speedup (nan for big BSTs)
+            const double *sorted_times[] = { sorted_point.t1, sorted_point.t2, sorted_point.t3 };
+            const double *sorted_deviations[] = { sorted_point.d1, sorted_point.d2, sorted_point.d3 };
+            const double *load_times[] = { load_point.t1, load_point.t2, load_point.t3 };
+            const double *load_deviations[] = { load_point.d1, load_point.d2, load_point.d3 };
+            for (int t = 0; t < 3; t++) {
+                double speedup[STATISTICS];
+                for (int s = 0; s < STATISTICS; s++)
+                    speedup[s] = sorted_times[t][s] / load_times[t][s];
+                line_add(&line, sorted_times[t], 15);
+                line_add(&line, sorted_deviations[t], 15);
+                line_add(&line, load_times[t], 15);
+                line_add(&line, load_deviations[t], 15);
+                line_add(&line, speedup, 3);
+            }
+        }
+        if (compare_split) {
+            // Cuts of trees of n keys
+            split_trees_time(iterations, &split_point);
+            // time AVL split, S.D., time AVL rebuild, S.D., time RBT split, S.D., time RBT rebuild, S.D.
+            line_add_records(&line, &split_point, 4);
+        }
+        if (compare_cpu) {
+            // time BST, S.D. BST, time AVL, S.D. AVL, time RBT, S.D. RBT, time B-tree, S.D. B-tree (CPU time)
+            line_add_records(&line, &cpu_point, 4);
+        }
+        if (compare_perf) {
+            // for BST, AVL, RBT and B-tree: cycles, instructions, L1d, LLC, branch and dTLB misses per operation
+            for (int tree = 0; tree < 4; tree++)
+                for (int c = 0; c < PERF_COUNTERS; c++)
+                    line_add_value(&line, counter_point.c[tree][c], 3);
+        }
+        chart_print(&line);
+    }
+    for (int s = 0; s < STATISTICS; s++)
+        if (chart_outputs[s] != NULL && chart_outputs[s] != stdout)
+            fclose(chart_outputs[s]);
     return 0;
 }
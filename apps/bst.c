@@ -4,203 +4,99 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-#define MAX_LINE_SIZE 1000   // maximum size of a line of input
-#define MAX_CMD_LENGTH 15   // maximum length of a command name
-
-/**
- * Extract command, key and data from command line.
- * @param cmd command to execute
- * @param key key to use
- * @param data data to insert in key
- */
-void scanLine(char *cmd, int *key, char *data) {
-    // scan line of text
-    char line[MAX_LINE_SIZE];
-    /*
-     * You can instruct the scanf to ignore the special characters
-     * by prefixing % by a space character.
-     */
-    scanf(" %[^\n]s", line);
-
-    char *tmp_cmd=strtok(line, " ");
-
-    /*
-     * strcpy doesn't allocate memory for you.
-     * you need to have the destination of strcpy be already
-     * allocated memory locations
-    */
-    strcpy(cmd, tmp_cmd);
-
-    char *param = strtok(NULL, "\n");
-
-    char tmp_data[MAX_LINE_SIZE];
-    strcpy(tmp_data, "");
-    // A null pointer is returned if there are no tokens left to retrieve.
-    if  (param != NULL) {
-        sscanf(param, "%d%s", key, tmp_data);
-        if ((strcmp(tmp_data, "") == 0)) {
-            strcpy(data, "");
-        } else {
-            strcpy(data, tmp_data);
-        }
-    } else {
-        strcpy(data, "");
-        *key = 0;
-    }
-}
-
-/**
- * Structure to represent each
- * node in a binary search tree
- */
-typedef struct bst_node
-{
-    int key;
-    char *data;
-    struct bst_node *left;
-    struct bst_node *right;
-} bst_node;
-
-/**
- * Create a new BST node
- * @param key node key
- * @param data node value
- * @return new BST node
- */
-struct bst_node* bst_create(int key, char *data)
-{
-    struct bst_node *new_node;
-    new_node = (struct bst_node *) malloc(sizeof(bst_node));
-    if (new_node == NULL)
-    {
-        fprintf (stderr, "create bst node fail\n");
-        exit(1);
-    }
-    new_node->key = key;
-    new_node->data = strdup(data);
-    new_node->left = NULL;
-    new_node->right = NULL;
-
-    return new_node;
-}
-
-/**
- * Insert new node in a BST
- * @param node root BST
- * @param key key to insert
- * @param data value to insert
- * @return BST with new node
- */
-struct bst_node* bst_insert(struct bst_node *node, int key, char *data) {
-    // Return a new node if the tree is empty
-    if (node == NULL)
-    {
-        return bst_create(key, data);
-    }
-
-    // Traverse to the right place and insert the node
-    if (key < node->key) {
-        node->left = bst_insert(node->left, key, data);
-    } else {
-        node->right = bst_insert(node->right, key, data);
-    }
-    return node;
-}
-
-/**
- * Search a node with key and, if found, print its value
- * @param node BST to search for the key
- * @param key key to search
- */
-void bst_find(struct bst_node* node, int key) {
-    if (node->key == key)
-        printf("%s", node->data);
-    if (node->key < key) {
-        if (node->right != NULL)
-            return bst_find(node->right, key);
-        else
-            printf("\n");
-    } else {
-        if (node->left != NULL)
-            return bst_find(node->left, key);
-        else
-            printf("\n");
-    }
-}
-
-/**
- * Remove all nodes from BST
- * Given a BST, remove its nodes in postorder (left, right, root)
- * @param node
- */
-void bst_clear(struct bst_node* node) {
-    if (node == NULL)
-        return;
-
-    // first recur on left subtree
-    bst_clear(node->left);
-
-    // then recur on right subtree
-    bst_clear(node->right);
-
-    // now deal with the node
-    free(node);
-    node = NULL;
-}
-
-/**
- * Show current bst with prefix expression (Polish notation)
- * Given a BST, print its nodes in preorder (root, left, right)
- * @param node bst to traverse
- */
-void bst_show(struct bst_node* node)
-{
-    if (node == NULL) {
-        printf("NULL ");
-        return;
-    }
-
-    /* first print data of node */
-    printf("%d:%s ", node->key, node->data);
-
-    /* then recur on left subtree */
-    bst_show(node->left);
-
-    /* now recur on right subtree */
-    bst_show(node->right);
-}
+#include "trees.h"
 
 /**
  * Execute command with parameters.
  * Available commands:
  *   insert: insert a new node with key and data
+ *   binsert: queue key and data, queued keys are inserted at once
+ *            before the next command of another kind
  *   find: bst_find a node with key and, if found, return data
+ *   delete: remove the node with key
  *   bst_clear: remove every node from tree
+ *   load: add the "key data" lines, sorted by key, of file data to the tree
+ *   range: print "key:data" of the nodes with key from key to data, in order
  *   bst_show: print tree nodes in preorder
+ * @param arena arena to allocate nodes from
+ * @param batch keys queued by binsert
+ * @param root BST root
  * @param command command to execute
- * @param key key to insert or search
+ * @param key key to insert, search or delete, lowest key of range
  * @param data data to insert in key
  * @return BST root after operation
  */
-struct bst_node* doCommand(struct bst_node* root, char *command, int key, char *data)  {
+struct bst_node* doCommand(struct arena *arena, struct pairs *batch, struct bst_node* root, char *command, int key, char *data)  {
+    if (batch->count > 0 && strcmp(command, "binsert") != 0)
+    {
+        root = bst_insert_batch(arena, root, batch);
+        pairs_clear(batch);
+    }
+
     if (strcmp(command, "insert") == 0)
     {
-        root = bst_insert(root, key, data);
+        root = bst_insert(arena, root, key, data);
+    }
+    else if (strcmp(command, "binsert") == 0)
+    {
+        pairs_add(batch, key, data);
+        if (batch->count == BATCH_MAX_SIZE)
+        {
+            root = bst_insert_batch(arena, root, batch);
+            pairs_clear(batch);
+        }
     }
     else if (strcmp(command, "find") == 0)
     {
-        bst_find(root, key);
+        const char *found = bst_find(root, key);
+        if (found != NULL)
+            output_string(found);
+        output_char('\n');
+    }
+    else if (strcmp(command, "delete") == 0)
+    {
+        root = bst_delete(arena, root, key);
     }
     else if (strcmp(command, "clear") == 0)
     {
-        bst_clear(root);
+        bst_clear(arena, root);
         root = NULL;
     }
+    else if (strcmp(command, "load") == 0)
+    {
+        struct pairs pairs;
+        pairs_init(&pairs);
+        if (pairs_read(&pairs, data) && pairs_sorted(&pairs))
+            root = bst_load(arena, root, &pairs);
+        else
+        {
+            output_string("Error! cannot load file");
+            output_char('\n');
+        }
+        pairs_free(&pairs);
+    }
+    else if (strcmp(command, "range") == 0)
+    {
+        // data is the highest key
+        int high = atoi(data);
+        struct bst_iterator it;
+        struct bst_node *node;
+        bst_iter_init(&it);
+        bst_iter_seek(&it, root, key);
+        while ((node = bst_iter_next(&it)) != NULL && node->key <= high)
+        {
+            output_int(node->key);
+            output_char(':');
+            output_string(payload_get(&node->data));
+            output_char(' ');
+        }
+        bst_iter_free(&it);
+        output_char('\n');
+    }
     else if (strcmp(command, "show") == 0)
     {
         bst_show(root);
-        printf("\n");
+        output_char('\n');
     }
     else if (strcmp(command, "exit") == 0)
     {
@@ -209,24 +105,42 @@ struct bst_node* doCommand(struct bst_node* root, char *command, int key, char *
         /* more else if clauses */
     else /* default: */
     {
-        printf("Error! operator is not correct");
+        output_string("Error! operator is not correct");
         exit(0);
     }
+    output_end_command();
     return root;
 }
 
-int main ()
+/**
+ * Read commands from stdin and execute them.
+ * Option -b: batch output, flushed only when the buffer fills or at exit.
+ */
+int main (int argc, char *argv[])
 {
+    output_init((argc > 1 && strcmp(argv[1], "-b") == 0) ? FLUSH_FULL : FLUSH_COMMAND);
     struct bst_node* root = NULL;
+    // All nodes live in one arena, released by clear
+    struct arena arena;
+    arena_init(&arena, ARENA_SLAB_SIZE);
+    // Keys of binsert commands, waiting to be inserted
+    struct pairs batch;
+    pairs_init(&batch);
+    // Commands are parsed in place from a large buffer of stdin
+    struct reader reader;
+    reader_init(&reader, 0);
     int key = 0;
-    char command[MAX_CMD_LENGTH];
-    char data[MAX_CMD_LENGTH];
+    char *command;
+    char *data;
 
-    while ((strcmp(command, "exit") != 0))
+    // read command, key and data from stdin
+    while (reader_next(&reader, &command, &key, &data))
     {
-        scanLine(command, &key, data); // read command, key and data from stdin
         // execute command
-        root = doCommand(root, (char *) &command, key, (char *) &data);
+        root = doCommand(&arena, &batch, root, command, key, data);
     }
+    reader_free(&reader);
+    pairs_free(&batch);
+    arena_free(&arena);
     return 0;
 }
@@ -0,0 +1,541 @@
+//
+// Binary Search Tree
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "trees.h"
+
+/**
+ * Create a new BST node
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param key node key
+ * @param data node value
+ * @return new BST node
+ */
+struct bst_node* bst_create(struct arena *arena, int key, char *data)
+{
+    struct bst_node *new_node;
+    if (arena != NULL)
+        new_node = (struct bst_node *) arena_alloc(arena, sizeof(bst_node));
+    else
+        new_node = (struct bst_node *) malloc(sizeof(bst_node));
+    if (new_node == NULL)
+    {
+        fprintf (stderr, "create bst node fail\n");
+        exit(1);
+    }
+    new_node->key = key;
+    payload_set(&new_node->data, arena, data);
+    new_node->left = NULL;
+    new_node->right = NULL;
+
+    return new_node;
+}
+
+/**
+ * Insert new node in a BST
+ * Walk down keeping a pointer to the link to follow, the new node
+ * is hooked to the empty link found at the end.
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param node root BST
+ * @param key key to insert
+ * @param data value to insert
+ * @return BST with new node
+ */
+struct bst_node* bst_insert(struct arena *arena, struct bst_node *node, int key, char *data) {
+    struct bst_node **link = &node;
+
+    // Traverse to the right place and insert the node
+    while (*link != NULL) {
+        if (key < (*link)->key)
+            link = &(*link)->left;
+        else
+            link = &(*link)->right;
+    }
+    *link = bst_create(arena, key, data);
+
+    return node;
+}
+
+/**
+ * Search a node with key and, if found, return its value
+ * @param node BST to search for the key
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* bst_find(struct bst_node* node, int key) {
+    while (node != NULL) {
+        if (node->key == key)
+            return payload_get(&node->data);
+        if (node->key < key)
+            node = node->right;
+        else
+            node = node->left;
+    }
+    return NULL;
+}
+
+/**
+ * Free a single BST node and its data
+ * @param arena arena the node comes from, NULL if allocated with malloc
+ * @param node node to free
+ */
+static void bst_destroy(struct arena *arena, struct bst_node *node)
+{
+    if (arena != NULL) {
+        arena_release(arena, node, sizeof(bst_node));
+    } else {
+        payload_free(&node->data);
+        free(node);
+    }
+}
+
+/**
+ * Delete the node with key from a BST
+ * A node with two children takes key and data of its successor
+ * (leftmost node of right subtree), which is unlinked in its place.
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node BST root
+ * @param key key to delete
+ * @return BST without the key
+ */
+struct bst_node* bst_delete(struct arena *arena, struct bst_node *node, int key) {
+    struct bst_node **link = &node;
+
+    // Traverse to the node to delete
+    while (*link != NULL && (*link)->key != key) {
+        if (key < (*link)->key)
+            link = &(*link)->left;
+        else
+            link = &(*link)->right;
+    }
+    if (*link == NULL)
+        return node;
+
+    struct bst_node *target = *link;
+    if (target->left != NULL && target->right != NULL) {
+        // find the successor, swap it with target and delete it instead
+        link = &target->right;
+        while ((*link)->left != NULL)
+            link = &(*link)->left;
+        struct bst_node *successor = *link;
+        struct payload data = target->data;
+        target->key = successor->key;
+        target->data = successor->data;
+        successor->data = data;
+        target = successor;
+    }
+
+    // target has at most one child: link it in place of target
+    *link = (target->left != NULL) ? target->left : target->right;
+    bst_destroy(arena, target);
+
+    return node;
+}
+
+/**
+ * Free all nodes allocated with malloc
+ * Given a BST, rotate the left child up until the node has none,
+ * then free the node and go on with its right child:
+ * no recursion and no extra memory, whatever the tree shape.
+ * @param node
+ */
+void bst_free_nodes(struct bst_node* node) {
+    while (node != NULL) {
+        if (node->left != NULL) {
+            // right rotation: left child becomes the subtree root
+            struct bst_node *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            // no left subtree: deal with the node, then go right
+            struct bst_node *right = node->right;
+            payload_free(&node->data);
+            free(node);
+            node = right;
+        }
+    }
+}
+
+/**
+ * Remove all nodes from BST
+ * Nodes taken from an arena are released at once in O(1)
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node BST root
+ */
+void bst_clear(struct arena *arena, struct bst_node* node) {
+    if (arena != NULL)
+        arena_clear(arena);
+    else
+        bst_free_nodes(node);
+}
+
+/**
+ * Print key and data of a node of a BST
+ * @param node node to print
+ */
+static void bst_show_node(struct bst_node* node)
+{
+    output_int(node->key);
+    output_char(':');
+    output_string(payload_get(&node->data));
+    output_char(' ');
+}
+
+/**
+ * Show current bst with prefix expression (Polish notation)
+ * Given a BST, print its nodes in preorder (root, left, right).
+ * Morris traversal: the rightmost node of each left subtree is temporarily
+ * threaded to its successor, so no recursion nor stack is needed.
+ * A thread found again marks the end of a left subtree, whose last node
+ * has an empty right child.
+ * @param node bst to traverse
+ */
+void bst_show(struct bst_node* node)
+{
+    struct bst_node *pred;
+    while (node != NULL) {
+        if (node->left == NULL) {
+            /* print data of node and its empty left subtree, then go right */
+            bst_show_node(node);
+            output_string("NULL ");
+            node = node->right;
+            continue;
+        }
+
+        // find the rightmost node of left subtree
+        pred = node->left;
+        while (pred->right != NULL && pred->right != node)
+            pred = pred->right;
+
+        if (pred->right == NULL) {
+            /* first visit: print data of node, thread it and go left */
+            bst_show_node(node);
+            pred->right = node;
+            node = node->left;
+        } else {
+            /* left subtree done: remove the thread, print its empty right child and go right */
+            pred->right = NULL;
+            output_string("NULL ");
+            node = node->right;
+        }
+    }
+    /* empty right child of the last node (or empty tree) */
+    output_string("NULL ");
+}
+
+/**
+ * Collect the nodes of a BST in order
+ * Morris traversal, as bst_show: no recursion nor stack whatever the tree shape.
+ * @param node BST root
+ * @param nodes nodes in order, NULL to count only
+ * @return number of nodes
+ */
+int bst_in_order(struct bst_node* node, struct bst_node **nodes)
+{
+    struct bst_node *pred;
+    int n = 0;
+    while (node != NULL) {
+        if (node->left == NULL) {
+            /* no left subtree: visit node, then go right */
+            if (nodes != NULL)
+                nodes[n] = node;
+            n++;
+            node = node->right;
+            continue;
+        }
+
+        // find the rightmost node of left subtree
+        pred = node->left;
+        while (pred->right != NULL && pred->right != node)
+            pred = pred->right;
+
+        if (pred->right == NULL) {
+            /* first visit: thread it and go left */
+            pred->right = node;
+            node = node->left;
+        } else {
+            /* left subtree done: remove the thread, visit node and go right */
+            pred->right = NULL;
+            if (nodes != NULL)
+                nodes[n] = node;
+            n++;
+            node = node->right;
+        }
+    }
+    return n;
+}
+
+/**
+ * Link nodes in order into a perfectly balanced BST in O(n)
+ * Node i in order takes slot i in order of an implicit complete tree,
+ * the children of slot k are slots 2k and 2k + 1.
+ * @param nodes nodes sorted by key
+ * @param n number of nodes
+ * @return BST root
+ */
+struct bst_node* bst_build(struct bst_node **nodes, int n)
+{
+    if (n == 0)
+        return NULL;
+    struct bst_node **slots = (struct bst_node **) malloc((n + 1) * sizeof(struct bst_node *));
+    if (slots == NULL)
+    {
+        fprintf (stderr, "create bst slots fail\n");
+        exit(1);
+    }
+    int k = implicit_first(n);
+    for (int i = 0; i < n; i++) {
+        slots[k] = nodes[i];
+        k = implicit_next(k, n);
+    }
+    for (k = 1; k <= n; k++) {
+        slots[k]->left = (2 * k <= n) ? slots[2 * k] : NULL;
+        slots[k]->right = (2 * k + 1 <= n) ? slots[2 * k + 1] : NULL;
+    }
+    struct bst_node *root = slots[1];
+    free(slots);
+    return root;
+}
+
+/**
+ * Add sorted pairs to a BST in O(n)
+ * Nodes of the BST and new nodes are merged in order, then linked again
+ * into a perfectly balanced BST. Equal keys are kept, new ones after.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node BST root
+ * @param pairs pairs sorted by key
+ * @return BST with new nodes
+ */
+struct bst_node* bst_load(struct arena *arena, struct bst_node *node, const struct pairs *pairs)
+{
+    int old = bst_in_order(node, NULL);
+    struct bst_node **nodes = (struct bst_node **) malloc((old + pairs->count + 1) * sizeof(struct bst_node *));
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create bst slots fail\n");
+        exit(1);
+    }
+    // old nodes at the end, merged from the start: writes never reach unread nodes
+    bst_in_order(node, nodes + pairs->count);
+    int a = pairs->count;
+    int end = pairs->count + old;
+    int b = 0;
+    int n = 0;
+    while (a < end || b < pairs->count) {
+        if (b == pairs->count || (a < end && nodes[a]->key <= pairs->keys[b])) {
+            nodes[n++] = nodes[a++];
+        } else {
+            nodes[n++] = bst_create(arena, pairs->keys[b], pairs_data(pairs, b));
+            b++;
+        }
+    }
+    node = bst_build(nodes, n);
+    free(nodes);
+    return node;
+}
+
+/**
+ * Count the nodes of a BST, stopping at limit
+ * Preorder walk, right children still to visit are kept in a growable stack.
+ * @param node BST root
+ * @param limit nodes to count at most
+ * @return number of nodes, limit if there are more
+ */
+static int bst_count(struct bst_node* node, int limit)
+{
+    struct bst_node **stack = NULL;
+    int capacity = 0;
+    int depth = 0;
+    int n = 0;
+
+    while (node != NULL && n < limit) {
+        n++;
+        if (node->right != NULL) {
+            if (depth == capacity) {
+                capacity = (capacity == 0) ? 64 : 2 * capacity;
+                stack = (struct bst_node **) realloc(stack, capacity * sizeof(struct bst_node *));
+                if (stack == NULL)
+                {
+                    fprintf (stderr, "create bst stack fail\n");
+                    exit(1);
+                }
+            }
+            stack[depth++] = node->right;
+        }
+        if (node->left != NULL)
+            node = node->left;
+        else
+            node = (depth > 0) ? stack[--depth] : NULL;
+    }
+    free(stack);
+    return n;
+}
+
+/**
+ * Merge sorted pairs into a BST, in O(m log(n / m + 1)) for a balanced BST
+ * A node splits the pairs of its subtree: smaller keys go down to its left
+ * subtree, greater or equal ones to its right subtree. Subtrees that get no
+ * pairs are not visited, pairs that reach an empty link are hooked there as a
+ * balanced subtree around their middle pair. Links still to visit are kept
+ * in a stack, one for each slice of pairs: no recursion, whatever the tree shape.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node BST root
+ * @param pairs pairs sorted by key
+ * @return BST with new nodes
+ */
+static struct bst_node* bst_merge(struct arena *arena, struct bst_node *node, const struct pairs *pairs)
+{
+    struct bst_slice {
+        struct bst_node **link;
+        int low;    // first pair of the subtree of link
+        int high;   // end of its pairs, excluded
+    } *stack;
+    int depth = 0;
+
+    if (pairs->count == 0)
+        return node;
+    stack = (struct bst_slice *) malloc(pairs->count * sizeof(struct bst_slice));
+    if (stack == NULL)
+    {
+        fprintf (stderr, "create bst stack fail\n");
+        exit(1);
+    }
+    stack[depth].link = &node;
+    stack[depth].low = 0;
+    stack[depth].high = pairs->count;
+    depth++;
+    // slices in the stack never overlap, there are at most pairs->count of them
+    while (depth > 0) {
+        struct bst_slice slice = stack[--depth];
+        struct bst_node *parent = *slice.link;
+        int less;
+        int greater;
+        if (parent == NULL) {
+            less = slice.low + (slice.high - slice.low) / 2;
+            parent = bst_create(arena, pairs->keys[less], pairs_data(pairs, less));
+            *slice.link = parent;
+            greater = less + 1;
+        } else {
+            // equal keys are kept, new ones after
+            less = batch_lower_bound(pairs->keys, slice.low, slice.high, parent->key);
+            greater = less;
+        }
+        if (less > slice.low) {
+            stack[depth].link = &parent->left;
+            stack[depth].low = slice.low;
+            stack[depth].high = less;
+            depth++;
+        }
+        if (slice.high > greater) {
+            stack[depth].link = &parent->right;
+            stack[depth].low = greater;
+            stack[depth].high = slice.high;
+            depth++;
+        }
+    }
+    free(stack);
+    return node;
+}
+
+/**
+ * Insert a batch of pairs in a BST
+ * A big enough batch is sorted by key and merged with the tree by bst_merge,
+ * a smaller one is inserted in arrival order, as one by one.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node BST root
+ * @param pairs pairs to insert, sorted in place when merged
+ * @return BST with new nodes
+ */
+struct bst_node* bst_insert_batch(struct arena *arena, struct bst_node *node, struct pairs *pairs)
+{
+    int limit = batch_merge_limit(pairs->count);
+    if (limit > 0 && batch_merges(pairs->count, bst_count(node, limit))) {
+        pairs_sort(pairs);
+        return bst_merge(arena, node, pairs);
+    }
+
+    for (int i = 0; i < pairs->count; i++)
+        node = bst_insert(arena, node, pairs->keys[i], pairs_data(pairs, i));
+    return node;
+}
+
+/**
+ * Initialize an in order cursor on a BST, no memory is allocated until the first bst_iter_seek
+ * @param it cursor to initialize
+ */
+void bst_iter_init(struct bst_iterator *it)
+{
+    it->stack = NULL;
+    it->depth = 0;
+    it->capacity = 0;
+}
+
+/**
+ * Push a node on the stack of a cursor, the stack doubles in size when full
+ * @param it cursor
+ * @param node node to visit later
+ */
+static void bst_iter_push(struct bst_iterator *it, struct bst_node *node)
+{
+    if (it->depth == it->capacity) {
+        it->capacity = (it->capacity == 0) ? 64 : 2 * it->capacity;
+        it->stack = (struct bst_node **) realloc(it->stack, it->capacity * sizeof(struct bst_node *));
+        if (it->stack == NULL)
+        {
+            fprintf (stderr, "create bst stack fail\n");
+            exit(1);
+        }
+    }
+    it->stack[it->depth++] = node;
+}
+
+/**
+ * Move a cursor to the first node of a BST whose key is not less than key
+ * Only the nodes on the path from the root are visited.
+ * @param it cursor
+ * @param root BST root
+ * @param key lowest key to visit
+ */
+void bst_iter_seek(struct bst_iterator *it, struct bst_node *root, int key)
+{
+    it->depth = 0;
+    while (root != NULL) {
+        if (root->key >= key) {
+            // root comes after the nodes of its left subtree
+            bst_iter_push(it, root);
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+}
+
+/**
+ * Get the node of a cursor and move it to the next node in order
+ * @param it cursor
+ * @return current node, NULL after the last node
+ */
+struct bst_node* bst_iter_next(struct bst_iterator *it)
+{
+    if (it->depth == 0)
+        return NULL;
+    struct bst_node *node = it->stack[--it->depth];
+    // next nodes: leftmost path of the right subtree
+    for (struct bst_node *next = node->right; next != NULL; next = next->left)
+        bst_iter_push(it, next);
+    return node;
+}
+
+/**
+ * Free the stack of a cursor
+ * @param it cursor
+ */
+void bst_iter_free(struct bst_iterator *it)
+{
+    free(it->stack);
+    bst_iter_init(it);
+}
@@ -0,0 +1,91 @@
+//
+// B-tree
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trees.h"
+
+/**
+ * Execute command with parameters.
+ * Available commands:
+ *   insert: insert key and data
+ *   find: btree_find a key and, if found, return data
+ *   delete: remove key and its data
+ *   btree_clear: remove every node from tree
+ *   btree_show: print tree nodes, keys in order
+ * @param arena arena to allocate nodes from
+ * @param root B-tree root
+ * @param command command to execute
+ * @param key key to insert, search or delete
+ * @param data data to insert in key
+ * @return B-tree root after operation
+ */
+struct btree_node* doCommand(struct arena *arena, struct btree_node* root, char *command, int key, char *data)  {
+    if (strcmp(command, "insert") == 0)
+    {
+        root = btree_insert(arena, root, key, data);
+    }
+    else if (strcmp(command, "find") == 0)
+    {
+        const char *found = btree_find(root, key);
+        if (found != NULL)
+            output_string(found);
+        output_char('\n');
+    }
+    else if (strcmp(command, "delete") == 0)
+    {
+        root = btree_delete(arena, root, key);
+    }
+    else if (strcmp(command, "clear") == 0)
+    {
+        btree_clear(arena, root);
+        root = NULL;
+    }
+    else if (strcmp(command, "show") == 0)
+    {
+        btree_show(root);
+        output_char('\n');
+    }
+    else if (strcmp(command, "exit") == 0)
+    {
+        exit(0);
+    }
+        /* more else if clauses */
+    else /* default: */
+    {
+        output_string("Error! operator is not correct");
+        exit(0);
+    }
+    output_end_command();
+    return root;
+}
+
+/**
+ * Read commands from stdin and execute them.
+ * Option -b: batch output, flushed only when the buffer fills or at exit.
+ */
+int main (int argc, char *argv[])
+{
+    output_init((argc > 1 && strcmp(argv[1], "-b") == 0) ? FLUSH_FULL : FLUSH_COMMAND);
+    struct btree_node* root = NULL;
+    // All nodes live in one arena, released by clear
+    struct arena arena;
+    arena_init(&arena, ARENA_SLAB_SIZE);
+    // Commands are parsed in place from a large buffer of stdin
+    struct reader reader;
+    reader_init(&reader, 0);
+    int key = 0;
+    char *command;
+    char *data;
+
+    // read command, key and data from stdin
+    while (reader_next(&reader, &command, &key, &data))
+    {
+        // execute command
+        root = doCommand(&arena, root, command, key, data);
+    }
+    reader_free(&reader);
+    arena_free(&arena);
+    return 0;
+}
@@ -0,0 +1,477 @@
+//
+// B-tree with SIMD search inside nodes
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "trees.h"
+
+#if BTREE_MAX_KEYS + 1 != 16
+#error "B-tree node search expects 16 key slots"
+#endif
+
+/**
+ * Create a new empty B-tree node
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param leaf 1 for a leaf, 0 for an internal node
+ * @return new B-tree node
+ */
+static struct btree_node* btree_create(struct arena *arena, int leaf)
+{
+    struct btree_node *new_node;
+    if (arena != NULL)
+        new_node = (struct btree_node *) arena_alloc(arena, sizeof(btree_node));
+    else
+        new_node = (struct btree_node *) malloc(sizeof(btree_node));
+    if (new_node == NULL)
+    {
+        fprintf (stderr, "create btree node fail\n");
+        exit(1);
+    }
+    for (int i = 0; i <= BTREE_MAX_KEYS; i++)
+        new_node->keys[i] = INT_MAX;
+    new_node->count = 0;
+    new_node->leaf = leaf;
+
+    return new_node;
+}
+
+/**
+ * Free a single B-tree node, its data is moved or freed by the caller
+ * @param arena arena the node comes from, NULL if allocated with malloc
+ * @param node node to free
+ */
+static void btree_destroy(struct arena *arena, struct btree_node *node)
+{
+    if (arena != NULL)
+        arena_release(arena, node, sizeof(btree_node));
+    else
+        free(node);
+}
+
+/**
+ * Get the position of key in a node, that is the number of node keys less than key
+ * Every slot is compared at once (unused slots hold INT_MAX, never less than key):
+ * each compare gives -1 in the lanes of keys less than key, the sum of lanes is the position.
+ * Without SSE2 keys are compared one at a time.
+ * @param node node to search
+ * @param key key to search
+ * @return index of key if it is in the node, otherwise index of the child to follow
+ */
+static inline int btree_position(const struct btree_node *node, int key)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+#if defined(__AVX2__)
+    __m256i k = _mm256_set1_epi32(key);
+    __m256i low = _mm256_cmpgt_epi32(k, _mm256_loadu_si256((const __m256i *) node->keys));
+    __m256i high = _mm256_cmpgt_epi32(k, _mm256_loadu_si256((const __m256i *) (node->keys + 8)));
+    __m256i sum = _mm256_add_epi32(low, high);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+#else
+    const __m128i *keys = (const __m128i *) node->keys;
+    __m128i k = _mm_set1_epi32(key);
+    __m128i s = _mm_add_epi32(
+            _mm_add_epi32(_mm_cmpgt_epi32(k, _mm_loadu_si128(keys)),
+                          _mm_cmpgt_epi32(k, _mm_loadu_si128(keys + 1))),
+            _mm_add_epi32(_mm_cmpgt_epi32(k, _mm_loadu_si128(keys + 2)),
+                          _mm_cmpgt_epi32(k, _mm_loadu_si128(keys + 3))));
+#endif
+    // add the four lanes
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return -_mm_cvtsi128_si32(s);
+#else
+    int i = 0;
+    while (i < node->count && node->keys[i] < key)
+        i++;
+    return i;
+#endif
+}
+
+/**
+ * Make room for a key at position i of a node
+ * Keys, data and right children from i on are moved one slot right.
+ * @param node node to open, not full
+ * @param i position of the new key
+ */
+static void btree_open(struct btree_node *node, int i)
+{
+    int moved = node->count - i;
+    memmove(&node->keys[i + 1], &node->keys[i], moved * sizeof(int));
+    memmove(&node->data[i + 1], &node->data[i], moved * sizeof(struct payload));
+    if (!node->leaf)
+        memmove(&node->child[i + 2], &node->child[i + 1], moved * sizeof(struct btree_node *));
+    node->count++;
+}
+
+/**
+ * Remove key i and its right child from a node
+ * Keys, data and right children after i are moved one slot left.
+ * @param node node to shrink
+ * @param i position of the key to remove
+ */
+static void btree_remove(struct btree_node *node, int i)
+{
+    int moved = node->count - i - 1;
+    memmove(&node->keys[i], &node->keys[i + 1], moved * sizeof(int));
+    memmove(&node->data[i], &node->data[i + 1], moved * sizeof(struct payload));
+    if (!node->leaf)
+        memmove(&node->child[i + 1], &node->child[i + 2], moved * sizeof(struct btree_node *));
+    node->count--;
+    node->keys[node->count] = INT_MAX;
+}
+
+/**
+ * Split the full child i of a node
+ * The child keeps its first BTREE_MIN_DEGREE - 1 keys, the last ones go to a new
+ * right sibling and the median key goes up to the node.
+ * @param arena arena to allocate the new node from, NULL to use malloc
+ * @param node parent node, not full
+ * @param i position of the full child
+ */
+static void btree_split(struct arena *arena, struct btree_node *node, int i)
+{
+    struct btree_node *full = node->child[i];
+    struct btree_node *right = btree_create(arena, full->leaf);
+    const int t = BTREE_MIN_DEGREE;
+
+    // last t - 1 keys to the new node
+    right->count = t - 1;
+    memcpy(right->keys, &full->keys[t], (t - 1) * sizeof(int));
+    memcpy(right->data, &full->data[t], (t - 1) * sizeof(struct payload));
+    if (!full->leaf)
+        memcpy(right->child, &full->child[t], t * sizeof(struct btree_node *));
+
+    // median key up to the node
+    btree_open(node, i);
+    node->keys[i] = full->keys[t - 1];
+    node->data[i] = full->data[t - 1];
+    node->child[i + 1] = right;
+
+    full->count = t - 1;
+    for (int j = t - 1; j < BTREE_MAX_KEYS; j++)
+        full->keys[j] = INT_MAX;
+}
+
+/**
+ * Insert new key in a B-tree
+ * Full nodes are split on the way down, so the key always fits in its leaf.
+ * Equal keys are not allowed: a key already in the tree is left as is.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param root B-tree root
+ * @param key key to insert
+ * @param data value to insert
+ * @return B-tree root
+ */
+struct btree_node* btree_insert(struct arena *arena, struct btree_node *root, int key, char *data)
+{
+    if (root == NULL)
+        root = btree_create(arena, 1);
+    else if (root->count == BTREE_MAX_KEYS) {
+        // the tree grows from the root
+        struct btree_node *new_root = btree_create(arena, 0);
+        new_root->child[0] = root;
+        btree_split(arena, new_root, 0);
+        root = new_root;
+    }
+
+    struct btree_node *node = root;
+    for (;;) {
+        int i = btree_position(node, key);
+        if (i < node->count && node->keys[i] == key)
+            return root;
+        if (node->leaf) {
+            btree_open(node, i);
+            node->keys[i] = key;
+            payload_set(&node->data[i], arena, data);
+            return root;
+        }
+        if (node->child[i]->count == BTREE_MAX_KEYS) {
+            btree_split(arena, node, i);
+            if (node->keys[i] == key)
+                return root;
+            if (node->keys[i] < key)
+                i++;
+        }
+        node = node->child[i];
+    }
+}
+
+/**
+ * Search a key and, if found, return its value
+ * @param node B-tree to search for the key
+ * @param key key to search
+ * @return key data if key exist, NULL otherwise
+ */
+const char* btree_find(struct btree_node* node, int key)
+{
+    while (node != NULL) {
+        int i = btree_position(node, key);
+        if (i < node->count && node->keys[i] == key)
+            return payload_get(&node->data[i]);
+        if (node->leaf)
+            return NULL;
+        node = node->child[i];
+    }
+    return NULL;
+}
+
+/**
+ * Merge child i + 1 of a node into child i, with key i of the node between them
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node parent node
+ * @param i position of the left child
+ */
+static void btree_merge(struct arena *arena, struct btree_node *node, int i)
+{
+    struct btree_node *left = node->child[i];
+    struct btree_node *right = node->child[i + 1];
+
+    left->keys[left->count] = node->keys[i];
+    left->data[left->count] = node->data[i];
+    memcpy(&left->keys[left->count + 1], right->keys, right->count * sizeof(int));
+    memcpy(&left->data[left->count + 1], right->data, right->count * sizeof(struct payload));
+    if (!left->leaf)
+        memcpy(&left->child[left->count + 1], right->child, (right->count + 1) * sizeof(struct btree_node *));
+    left->count += right->count + 1;
+
+    btree_remove(node, i);
+    btree_destroy(arena, right);
+}
+
+/**
+ * Give child i of a node at least BTREE_MIN_DEGREE keys before going down to it
+ * A key is moved from a sibling through the node if the sibling can spare
+ * it, otherwise the child is merged with a sibling.
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node parent node
+ * @param i position of the child
+ * @return child to go down to
+ */
+static struct btree_node* btree_fill(struct arena *arena, struct btree_node *node, int i)
+{
+    struct btree_node *child = node->child[i];
+
+    if (i > 0 && node->child[i - 1]->count >= BTREE_MIN_DEGREE) {
+        // take the last key of the left sibling
+        struct btree_node *left = node->child[i - 1];
+        memmove(&child->keys[1], child->keys, child->count * sizeof(int));
+        memmove(&child->data[1], child->data, child->count * sizeof(struct payload));
+        if (!child->leaf) {
+            memmove(&child->child[1], child->child, (child->count + 1) * sizeof(struct btree_node *));
+            child->child[0] = left->child[left->count];
+        }
+        child->keys[0] = node->keys[i - 1];
+        child->data[0] = node->data[i - 1];
+        child->count++;
+        node->keys[i - 1] = left->keys[left->count - 1];
+        node->data[i - 1] = left->data[left->count - 1];
+        left->count--;
+        left->keys[left->count] = INT_MAX;
+    } else if (i < node->count && node->child[i + 1]->count >= BTREE_MIN_DEGREE) {
+        // take the first key of the right sibling
+        struct btree_node *right = node->child[i + 1];
+        child->keys[child->count] = node->keys[i];
+        child->data[child->count] = node->data[i];
+        if (!child->leaf)
+            child->child[child->count + 1] = right->child[0];
+        child->count++;
+        node->keys[i] = right->keys[0];
+        node->data[i] = right->data[0];
+        if (!right->leaf)
+            memmove(right->child, &right->child[1], right->count * sizeof(struct btree_node *));
+        memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(int));
+        memmove(right->data, &right->data[1], (right->count - 1) * sizeof(struct payload));
+        right->count--;
+        right->keys[right->count] = INT_MAX;
+    } else if (i < node->count) {
+        btree_merge(arena, node, i);
+    } else {
+        btree_merge(arena, node, i - 1);
+        child = node->child[i - 1];
+    }
+    return child;
+}
+
+/**
+ * Delete key from a B-tree
+ * One pass down: every node entered has at least BTREE_MIN_DEGREE keys, so
+ * a key can be taken out of it. A key of an internal node is replaced by its
+ * predecessor or successor, which is deleted in turn from the subtree below.
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param root B-tree root
+ * @param key key to delete
+ * @return B-tree without the key
+ */
+struct btree_node* btree_delete(struct arena *arena, struct btree_node *root, int key)
+{
+    struct btree_node *node = root;
+    // data of key must be freed, that is key has not been moved up in place of another key
+    int owned = 1;
+
+    while (node != NULL) {
+        int i = btree_position(node, key);
+        struct btree_node *next;
+        if (i < node->count && node->keys[i] == key) {
+            if (node->leaf) {
+                if (owned && arena == NULL)
+                    payload_free(&node->data[i]);
+                btree_remove(node, i);
+                break;
+            }
+            if (node->child[i]->count >= BTREE_MIN_DEGREE) {
+                // replace key with its predecessor, then delete the predecessor
+                struct btree_node *pred = node->child[i];
+                while (!pred->leaf)
+                    pred = pred->child[pred->count];
+                if (owned && arena == NULL)
+                    payload_free(&node->data[i]);
+                key = pred->keys[pred->count - 1];
+                node->keys[i] = key;
+                node->data[i] = pred->data[pred->count - 1];
+                next = node->child[i];
+                owned = 0;
+            } else if (node->child[i + 1]->count >= BTREE_MIN_DEGREE) {
+                // replace key with its successor, then delete the successor
+                struct btree_node *succ = node->child[i + 1];
+                while (!succ->leaf)
+                    succ = succ->child[0];
+                if (owned && arena == NULL)
+                    payload_free(&node->data[i]);
+                key = succ->keys[0];
+                node->keys[i] = key;
+                node->data[i] = succ->data[0];
+                next = node->child[i + 1];
+                owned = 0;
+            } else {
+                // both children are minimal: merge them around key and go on in the result
+                btree_merge(arena, node, i);
+                next = node->child[i];
+            }
+        } else {
+            if (node->leaf)
+                break;
+            next = node->child[i];
+            if (next->count < BTREE_MIN_DEGREE)
+                next = btree_fill(arena, node, i);
+        }
+        // a merge can empty the root: the tree shrinks from the root
+        if (root->count == 0) {
+            btree_destroy(arena, root);
+            root = next;
+        }
+        node = next;
+    }
+
+    if (root != NULL && root->count == 0) {
+        btree_destroy(arena, root);
+        root = NULL;
+    }
+    return root;
+}
+
+/**
+ * Free all nodes allocated with malloc
+ * Nodes are freed in postorder, the path from the root is kept in a stack.
+ * @param node B-tree root
+ */
+void btree_free_nodes(struct btree_node* node)
+{
+    struct btree_node *path[BTREE_MAX_HEIGHT];
+    int next[BTREE_MAX_HEIGHT];
+    int depth = 0;
+
+    if (node == NULL)
+        return;
+    path[0] = node;
+    next[0] = 0;
+    while (depth >= 0) {
+        node = path[depth];
+        if (!node->leaf && next[depth] <= node->count) {
+            // go down to the next child
+            path[depth + 1] = node->child[next[depth]++];
+            next[depth + 1] = 0;
+            depth++;
+        } else {
+            // children done: free the node
+            for (int i = 0; i < node->count; i++)
+                payload_free(&node->data[i]);
+            free(node);
+            depth--;
+        }
+    }
+}
+
+/**
+ * Remove all nodes from B-tree
+ * Nodes taken from an arena are released at once in O(1)
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node B-tree root
+ */
+void btree_clear(struct arena *arena, struct btree_node* node)
+{
+    if (arena != NULL)
+        arena_clear(arena);
+    else
+        btree_free_nodes(node);
+}
+
+/**
+ * Print key and data i of a node of a B-tree
+ * @param node node to print
+ * @param i position of the key
+ */
+static void btree_show_key(struct btree_node* node, int i)
+{
+    output_int(node->keys[i]);
+    output_char(':');
+    output_string(payload_get(&node->data[i]));
+    output_char(' ');
+}
+
+/**
+ * Show current B-tree
+ * Each node is printed between brackets, with its keys in order and each
+ * child subtree before the key following it: [ child key child key child ]
+ * @param node B-tree to traverse
+ */
+void btree_show(struct btree_node* node)
+{
+    struct btree_node *path[BTREE_MAX_HEIGHT];
+    int next[BTREE_MAX_HEIGHT];
+    int depth = 0;
+
+    if (node == NULL) {
+        output_string("NULL ");
+        return;
+    }
+    path[0] = node;
+    next[0] = 0;
+    output_string("[ ");
+    while (depth >= 0) {
+        node = path[depth];
+        if (node->leaf) {
+            for (int i = 0; i < node->count; i++)
+                btree_show_key(node, i);
+            output_string("] ");
+            depth--;
+        } else if (next[depth] > node->count) {
+            output_string("] ");
+            depth--;
+        } else {
+            // key before the child, then go down to the child
+            if (next[depth] > 0)
+                btree_show_key(node, next[depth] - 1);
+            path[depth + 1] = node->child[next[depth]++];
+            next[depth + 1] = 0;
+            depth++;
+            output_string("[ ");
+        }
+    }
+}
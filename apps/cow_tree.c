@@ -0,0 +1,330 @@
+//
+// Copy-on-write AVL: lookups take no lock, inserts copy the path they change
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cow_tree.h"
+
+/**
+ * Get the height of the node
+ * @param node cow_node
+ * @return height of the node
+ */
+static int height(struct cow_node* node)
+{
+    if (node == NULL)
+        return 0;
+    return node->height;
+}
+
+/**
+ * Get maximum of two integers
+ * @param a int first integer
+ * @param b int second integer
+ * @return max of two values
+ */
+static int max(int a, int b)
+{
+    return (a > b)? a : b;
+}
+
+/**
+ * Right rotate a subtree rooted with an unpublished node
+ * @param root cow_node subtree root, its left child is not published either
+ * @return rotated subtree
+ */
+static struct cow_node* cow_right_rotate(struct cow_node* root)
+{
+    struct cow_node* x = root->left;
+    root->left = x->right;
+    x->right = root;
+    root->height = max(height(root->left), height(root->right))+1;
+    x->height = max(height(x->left), height(x->right))+1;
+    return x;
+}
+
+/**
+ * Left rotate a subtree rooted with an unpublished node
+ * @param root cow_node subtree root, its right child is not published either
+ * @return rotated subtree
+ */
+static struct cow_node* cow_left_rotate(struct cow_node* root)
+{
+    struct cow_node* y = root->right;
+    root->right = y->left;
+    y->left = root;
+    root->height = max(height(root->left), height(root->right))+1;
+    y->height = max(height(y->left), height(y->right))+1;
+    return y;
+}
+
+/**
+ * Create a new cow_node
+ * @param key node key
+ * @param data node value, copied
+ * @return new node, not published
+ */
+static struct cow_node* cow_create(int key, const char *data)
+{
+    struct cow_node *new_node = (struct cow_node *) malloc(sizeof(cow_node));
+    if (new_node == NULL)
+    {
+        fprintf (stderr, "create cow node fail\n");
+        exit(1);
+    }
+    new_node->key = key;
+    payload_set(&new_node->data, NULL, data);
+    new_node->left = NULL;
+    new_node->right = NULL;
+    new_node->height = 1;
+    return new_node;
+}
+
+/**
+ * Copy a node, with its own copy of data
+ * @param node node to copy
+ * @return copy, not published
+ */
+static struct cow_node* cow_copy(struct cow_node *node)
+{
+    struct cow_node *copy = cow_create(node->key, payload_get(&node->data));
+    copy->left = node->left;
+    copy->right = node->right;
+    copy->height = node->height;
+    return copy;
+}
+
+/**
+ * Free a single node and its data
+ * @param node node to free
+ */
+static void cow_destroy(struct cow_node *node)
+{
+    payload_free(&node->data);
+    free(node);
+}
+
+/**
+ * Initialize an empty copy-on-write AVL
+ * @param tree tree to initialize
+ */
+void cow_init(struct cow_tree *tree)
+{
+    tree->root = NULL;
+    tree->epoch = COW_IDLE + 1;
+    pthread_mutex_init(&tree->write_lock, NULL);
+    tree->reader_count = 0;
+    for (int i = 0; i < COW_MAX_READERS; i++)
+        tree->readers[i].epoch = COW_IDLE;
+    tree->retired = NULL;
+    tree->retired_count = 0;
+    tree->retired_capacity = 0;
+}
+
+/**
+ * Register a reader thread, each reader thread needs its own slot
+ * @param tree copy-on-write AVL
+ * @return reader slot
+ */
+int cow_reader_register(struct cow_tree *tree)
+{
+    int reader = __atomic_fetch_add(&tree->reader_count, 1, __ATOMIC_SEQ_CST);
+    if (reader >= COW_MAX_READERS)
+    {
+        fprintf (stderr, "register cow reader fail\n");
+        exit(1);
+    }
+    return reader;
+}
+
+/**
+ * Enter a read: nodes reached from the root stay valid until cow_read_end
+ * The epoch is announced, then checked again: if an insert advanced it in
+ * between, that insert may not have seen the announce, so announce again.
+ * @param tree copy-on-write AVL
+ * @param reader reader slot
+ */
+void cow_read_begin(struct cow_tree *tree, int reader)
+{
+    unsigned long epoch;
+    do {
+        epoch = __atomic_load_n(&tree->epoch, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&tree->readers[reader].epoch, epoch, __ATOMIC_SEQ_CST);
+    } while (__atomic_load_n(&tree->epoch, __ATOMIC_SEQ_CST) != epoch);
+}
+
+/**
+ * Leave a read: nodes and data found since cow_read_begin may be freed
+ * @param tree copy-on-write AVL
+ * @param reader reader slot
+ */
+void cow_read_end(struct cow_tree *tree, int reader)
+{
+    __atomic_store_n(&tree->readers[reader].epoch, COW_IDLE, __ATOMIC_RELEASE);
+}
+
+/**
+ * Search a key and, if found, return its value, without locks
+ * Must be called between cow_read_begin and cow_read_end.
+ * @param tree copy-on-write AVL
+ * @param key key to search
+ * @return key data if key exist, NULL otherwise
+ */
+const char* cow_find(struct cow_tree *tree, int key)
+{
+    struct cow_node *node = __atomic_load_n(&tree->root, __ATOMIC_SEQ_CST);
+    while (node != NULL) {
+        if (node->key == key)
+            return payload_get(&node->data);
+        if (node->key < key)
+            node = node->right;
+        else
+            node = node->left;
+    }
+    return NULL;
+}
+
+/**
+ * Add a node unlinked in the current epoch to the retired nodes
+ * @param tree copy-on-write AVL, write_lock held
+ * @param node node no more reachable from the next root
+ */
+static void cow_retire(struct cow_tree *tree, struct cow_node *node)
+{
+    if (tree->retired_count == tree->retired_capacity) {
+        tree->retired_capacity = (tree->retired_capacity == 0) ? 1024 : 2 * tree->retired_capacity;
+        tree->retired = (struct cow_retired *) realloc(tree->retired,
+                                                       tree->retired_capacity * sizeof(struct cow_retired));
+        if (tree->retired == NULL)
+        {
+            fprintf (stderr, "create cow retired list fail\n");
+            exit(1);
+        }
+    }
+    tree->retired[tree->retired_count].node = node;
+    tree->retired[tree->retired_count++].epoch = tree->epoch;
+}
+
+/**
+ * Free the retired nodes no reader can hold any more
+ * Nodes are retired in epoch order, so the freed ones are a prefix.
+ * @param tree copy-on-write AVL, write_lock held
+ */
+static void cow_reclaim(struct cow_tree *tree)
+{
+    unsigned long oldest = __atomic_load_n(&tree->epoch, __ATOMIC_SEQ_CST);
+    int readers = __atomic_load_n(&tree->reader_count, __ATOMIC_SEQ_CST);
+    if (readers > COW_MAX_READERS)
+        readers = COW_MAX_READERS;
+    for (int i = 0; i < readers; i++) {
+        unsigned long epoch = __atomic_load_n(&tree->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != COW_IDLE && epoch < oldest)
+            oldest = epoch;
+    }
+    int freed = 0;
+    while (freed < tree->retired_count && tree->retired[freed].epoch < oldest)
+        cow_destroy(tree->retired[freed++].node);
+    if (freed > 0) {
+        memmove(tree->retired, tree->retired + freed,
+                (tree->retired_count - freed) * sizeof(struct cow_retired));
+        tree->retired_count -= freed;
+    }
+}
+
+/**
+ * Insert new node in a copy-on-write AVL
+ * Nodes on the path are copied and the copies rebalanced like avl_insert
+ * does: rotations only change copies, readers still see the old path.
+ * The new root is published at once, the old path is retired.
+ * @param tree copy-on-write AVL
+ * @param key key to insert, equal keys are not allowed
+ * @param data value to insert, copied
+ */
+void cow_insert(struct cow_tree *tree, int key, const char *data)
+{
+    struct cow_node **path[AVL_MAX_HEIGHT];
+    int depth = 0;
+
+    pthread_mutex_lock(&tree->write_lock);
+    struct cow_node *root = __atomic_load_n(&tree->root, __ATOMIC_RELAXED);
+    for (struct cow_node *node = root; node != NULL; node = (key < node->key) ? node->left : node->right) {
+        if (node->key == key) {
+            // Equal keys are not allowed: nothing to copy
+            pthread_mutex_unlock(&tree->write_lock);
+            return;
+        }
+    }
+
+    // copy the path down to the new leaf
+    struct cow_node **link = &root;
+    while (*link != NULL) {
+        struct cow_node *copy = cow_copy(*link);
+        cow_retire(tree, *link);
+        *link = copy;
+        path[depth++] = link;
+        link = (key < copy->key) ? &copy->left : &copy->right;
+    }
+    *link = cow_create(key, data);
+
+    while (depth > 0) {
+        link = path[--depth];
+        struct cow_node *parent = *link;
+        int old_height = parent->height;
+        parent->height = 1 + max(height(parent->left), height(parent->right));
+        int balance = height(parent->left) - height(parent->right);
+
+        // Left Left and Left Right Cases: the left child is a copy, so is its right child if rotated
+        if (balance > 1) {
+            if (key > parent->left->key)
+                parent->left = cow_left_rotate(parent->left);
+            *link = cow_right_rotate(parent);
+        }
+        // Right Right and Right Left Cases
+        else if (balance < -1) {
+            if (key < parent->right->key)
+                parent->right = cow_right_rotate(parent->right);
+            *link = cow_left_rotate(parent);
+        }
+
+        // Subtree height unchanged: copies above are still balanced
+        if ((*link)->height == old_height)
+            break;
+    }
+
+    // publish, then readers announcing the next epoch cannot reach the old path
+    __atomic_store_n(&tree->root, root, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&tree->epoch, 1, __ATOMIC_SEQ_CST);
+    cow_reclaim(tree);
+    pthread_mutex_unlock(&tree->write_lock);
+}
+
+/**
+ * Free all nodes of a copy-on-write AVL, no thread may use it any more
+ * @param tree copy-on-write AVL
+ */
+void cow_free(struct cow_tree *tree)
+{
+    struct cow_node *node = tree->root;
+    // same walk as avl_free_nodes: rotate left children up, no stack needed
+    while (node != NULL) {
+        if (node->left != NULL) {
+            struct cow_node *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            struct cow_node *right = node->right;
+            cow_destroy(node);
+            node = right;
+        }
+    }
+    for (int i = 0; i < tree->retired_count; i++)
+        cow_destroy(tree->retired[i].node);
+    free(tree->retired);
+    pthread_mutex_destroy(&tree->write_lock);
+    tree->root = NULL;
+    tree->retired = NULL;
+    tree->retired_count = 0;
+    tree->retired_capacity = 0;
+}
@@ -0,0 +1,75 @@
+//
+// Copy-on-write AVL: lookups take no lock, inserts copy the path they change
+//
+#ifndef COW_TREE_H
+#define COW_TREE_H
+
+#include <pthread.h>
+#include "trees.h"
+
+#define COW_MAX_READERS 64   // reader threads registered on a tree, at most
+#define COW_ALIGN 64         // reader slots are one cache line each
+#define COW_IDLE 0           // epoch of a reader slot outside of a read
+
+/**
+ * Structure to represent each node in a copy-on-write AVL
+ * A node reachable from the published root is never changed: inserts
+ * change copies of the nodes on their path, then publish a new root.
+ */
+typedef struct cow_node
+{
+    int key;
+    struct payload data;
+    int height;
+    struct cow_node *left;
+    struct cow_node *right;
+} cow_node;
+
+/**
+ * Structure to represent the epoch announced by a reader thread
+ * while it reads the tree, COW_IDLE between reads
+ */
+struct cow_reader
+{
+    unsigned long epoch;
+    char pad[COW_ALIGN - sizeof(unsigned long)];
+};
+
+/**
+ * Structure to represent a node replaced by an insert, freed once
+ * no reader can still hold it
+ */
+struct cow_retired
+{
+    struct cow_node *node;
+    unsigned long epoch;    // epoch when the node was unlinked
+};
+
+/**
+ * Structure to represent a copy-on-write AVL
+ * Readers load the root without locks, writers are serialized by a mutex.
+ * Replaced nodes are reclaimed by epochs: a node unlinked in epoch e is freed
+ * when every reader inside a read announced an epoch after e.
+ */
+struct cow_tree
+{
+    struct cow_node *root;          // published root, read and written atomically
+    unsigned long epoch;            // global epoch, advanced by every insert
+    pthread_mutex_t write_lock;
+    int reader_count;
+    struct cow_reader readers[COW_MAX_READERS];
+    // nodes waiting for readers to leave, written under write_lock only
+    struct cow_retired *retired;
+    int retired_count;
+    int retired_capacity;
+};
+
+void cow_init(struct cow_tree *tree);
+int cow_reader_register(struct cow_tree *tree);
+void cow_read_begin(struct cow_tree *tree, int reader);
+void cow_read_end(struct cow_tree *tree, int reader);
+const char* cow_find(struct cow_tree *tree, int key);
+void cow_insert(struct cow_tree *tree, int key, const char *data);
+void cow_free(struct cow_tree *tree);
+
+#endif //COW_TREE_H
@@ -0,0 +1,280 @@
+//
+// Frozen trees: read-only copies of a tree in an implicit, pointer-free layout
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include "frozen_trees.h"
+
+#define FROZEN_ALIGN 64   // keys array is aligned to a cache line
+
+#if defined(__GNUC__)
+#define FROZEN_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define FROZEN_PREFETCH(p)
+#endif
+
+/**
+ * Initialize an empty frozen tree, that is a thawed one
+ * @param frozen frozen tree to initialize
+ */
+void frozen_init(struct frozen *frozen)
+{
+    frozen->layout = EYTZINGER;
+    frozen->size = 0;
+    frozen->height = 0;
+    frozen->keys = NULL;
+    frozen->values = NULL;
+    frozen->memory = NULL;
+}
+
+/**
+ * Free the arrays of a frozen tree, the tree is thawed
+ * @param frozen frozen tree to free
+ */
+void frozen_free(struct frozen *frozen)
+{
+    free(frozen->memory);
+    free(frozen->values);
+    frozen_init(frozen);
+}
+
+/**
+ * Allocate the arrays of a frozen tree
+ * @param frozen frozen tree
+ * @param slots number of slots (slot 0 included)
+ */
+static void frozen_alloc(struct frozen *frozen, int slots)
+{
+    frozen->memory = malloc(slots * sizeof(int) + FROZEN_ALIGN);
+    frozen->values = (const char **) malloc(slots * sizeof(const char *));
+    if (frozen->memory == NULL || frozen->values == NULL)
+    {
+        fprintf (stderr, "create frozen tree fail\n");
+        exit(1);
+    }
+    uintptr_t address = (uintptr_t) frozen->memory;
+    frozen->keys = (int *) ((address + FROZEN_ALIGN - 1) & ~((uintptr_t) FROZEN_ALIGN - 1));
+}
+
+/**
+ * Compute the van Emde Boas recursion of an implicit tree
+ * A tree of height h is split in a top tree of height h / 2 and the bottom
+ * subtrees hanging from it, each one stored after the other and split in
+ * turn. For every depth d where bottom subtrees are rooted, keep depth and
+ * size of the top tree and size of the bottom subtrees.
+ * @param frozen frozen tree, height already set
+ */
+static void veb_split(struct frozen *frozen)
+{
+    int todo_depth[2 * FROZEN_MAX_HEIGHT];
+    int todo_height[2 * FROZEN_MAX_HEIGHT];
+    int todo = 0;
+
+    todo_depth[todo] = 0;
+    todo_height[todo++] = frozen->height;
+    while (todo > 0) {
+        int depth = todo_depth[--todo];
+        int height = todo_height[todo];
+        if (height <= 1)
+            continue;
+        int top_height = height / 2;
+        int bottom_depth = depth + top_height;
+        frozen->top_depth[bottom_depth] = depth;
+        frozen->top_size[bottom_depth] = (1 << top_height) - 1;
+        frozen->bottom_size[bottom_depth] = (1 << (height - top_height)) - 1;
+        // split top tree and bottom subtrees
+        todo_depth[todo] = depth;
+        todo_height[todo++] = top_height;
+        todo_depth[todo] = bottom_depth;
+        todo_height[todo++] = height - top_height;
+    }
+}
+
+/**
+ * Build a frozen tree from keys in order
+ * Eytzinger layout uses slots 1 to n. Van Emde Boas layout needs a complete
+ * tree: the slots after the last key in order hold INT_MAX, with no data.
+ * @param frozen frozen tree to build
+ * @param keys keys in order
+ * @param values data of the keys
+ * @param n number of keys
+ * @param layout order of keys in the array
+ */
+static void frozen_build(struct frozen *frozen, const int *keys, const char **values, int n,
+                         enum frozenLayout layout)
+{
+    frozen_free(frozen);
+    frozen->layout = layout;
+    frozen->height = 0;
+    while (((1 << frozen->height) - 1) < n)
+        frozen->height++;
+
+    if (layout == EYTZINGER) {
+        frozen->size = n;
+        frozen_alloc(frozen, n + 1);
+        int k = implicit_first(n);
+        for (int i = 0; i < n; i++) {
+            frozen->keys[k] = keys[i];
+            frozen->values[k] = values[i];
+            k = implicit_next(k, n);
+        }
+        return;
+    }
+
+    frozen->size = (1 << frozen->height) - 1;
+    frozen_alloc(frozen, frozen->size + 1);
+    veb_split(frozen);
+    // position in the array of each slot, in breadth first order
+    int *position = (int *) malloc((frozen->size + 1) * sizeof(int));
+    if (position == NULL)
+    {
+        fprintf (stderr, "create frozen tree fail\n");
+        exit(1);
+    }
+    int depth = 0;
+    position[1] = 0;
+    for (int k = 2; k <= frozen->size; k++) {
+        if ((k & (k - 1)) == 0)
+            depth++;
+        int top_depth = frozen->top_depth[depth];
+        int top_size = frozen->top_size[depth];
+        position[k] = position[k >> (depth - top_depth)] + top_size
+                      + (k & top_size) * frozen->bottom_size[depth];
+    }
+    int k = implicit_first(frozen->size);
+    for (int i = 0; i < frozen->size; i++) {
+        frozen->keys[position[k]] = (i < n) ? keys[i] : INT_MAX;
+        frozen->values[position[k]] = (i < n) ? values[i] : NULL;
+        k = implicit_next(k, frozen->size);
+    }
+    free(position);
+}
+
+/**
+ * Search a key in a frozen tree and, if found, return its value
+ * Both layouts go down the implicit tree to the first key not less than
+ * key, the next slot is chosen by a compare result, not a branch.
+ * Eytzinger layout prefetches the slots four levels below, they share a cache line.
+ * @param frozen frozen tree to search for the key
+ * @param key key to search
+ * @return key data if key exist, NULL otherwise
+ */
+const char* frozen_find(const struct frozen *frozen, int key)
+{
+    const int *keys = frozen->keys;
+
+    if (frozen->layout == EYTZINGER) {
+        int k = 1;
+        while (k <= frozen->size) {
+            FROZEN_PREFETCH(keys + 16 * (size_t) k);
+            k = 2 * k + (keys[k] < key);
+        }
+        // undo the right turns after the last left turn
+        while (k & 1)
+            k >>= 1;
+        k >>= 1;
+        if (k != 0 && keys[k] == key)
+            return frozen->values[k];
+        return NULL;
+    }
+
+    int position[FROZEN_MAX_HEIGHT];
+    int found = -1;
+    int k = 1;
+    for (int depth = 0; depth < frozen->height; depth++) {
+        if (depth == 0)
+            position[0] = 0;
+        else
+            position[depth] = position[frozen->top_depth[depth]] + frozen->top_size[depth]
+                              + (k & frozen->top_size[depth]) * frozen->bottom_size[depth];
+        int right = keys[position[depth]] < key;
+        found = right ? found : position[depth];
+        k = 2 * k + right;
+    }
+    if (found >= 0 && keys[found] == key)
+        return frozen->values[found];
+    return NULL;
+}
+
+/**
+ * Allocate arrays for n keys in order
+ * @param n number of keys
+ * @param keys keys array
+ * @param values data array
+ */
+static void in_order_alloc(int n, int **keys, const char ***values)
+{
+    *keys = (int *) malloc((n + 1) * sizeof(int));
+    *values = (const char **) malloc((n + 1) * sizeof(const char *));
+    if (*keys == NULL || *values == NULL)
+    {
+        fprintf (stderr, "create frozen tree fail\n");
+        exit(1);
+    }
+}
+
+/**
+ * Freeze an AVL: copy it in an implicit layout
+ * @param frozen frozen tree, its previous content is freed
+ * @param root AVL root
+ * @param layout order of keys in the array
+ */
+void avl_freeze(struct frozen *frozen, struct avl_node *root, enum frozenLayout layout)
+{
+    int *keys;
+    const char **values;
+    int n = avl_in_order(root, NULL);
+    struct avl_node **nodes = (struct avl_node **) malloc((n + 1) * sizeof(struct avl_node *));
+    in_order_alloc(n, &keys, &values);
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create frozen tree fail\n");
+        exit(1);
+    }
+    avl_in_order(root, nodes);
+    for (int i = 0; i < n; i++) {
+        keys[i] = nodes[i]->key;
+        values[i] = payload_get(&nodes[i]->data);
+    }
+    frozen_build(frozen, keys, values, n, layout);
+    free(nodes);
+    free(keys);
+    free(values);
+}
+
+/**
+ * Freeze a RBT: copy it in an implicit layout
+ * @param frozen frozen tree, its previous content is freed
+ * @param root RBT root
+ * @param layout order of keys in the array
+ */
+void rbt_freeze(struct frozen *frozen, struct rbt_node *root, enum frozenLayout layout)
+{
+    int *keys;
+    const char **values;
+    int n = rbt_in_order(root, NULL);
+    struct rbt_node **nodes = (struct rbt_node **) malloc((n + 1) * sizeof(struct rbt_node *));
+    in_order_alloc(n, &keys, &values);
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create frozen tree fail\n");
+        exit(1);
+    }
+    rbt_in_order(root, nodes);
+    // equal keys are allowed in RBT: keep one, with the data rbt_find returns
+    int unique = 0;
+    for (int i = 0; i < n; i++) {
+        if (unique > 0 && keys[unique - 1] == nodes[i]->key) {
+            values[unique - 1] = rbt_find(root, nodes[i]->key);
+            continue;
+        }
+        keys[unique] = nodes[i]->key;
+        values[unique++] = payload_get(&nodes[i]->data);
+    }
+    frozen_build(frozen, keys, values, unique, layout);
+    free(nodes);
+    free(keys);
+    free(values);
+}
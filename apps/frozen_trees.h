@@ -0,0 +1,56 @@
+//
+// Frozen trees: read-only copies of a tree in an implicit, pointer-free layout
+//
+#ifndef FROZEN_TREES_H
+#define FROZEN_TREES_H
+
+#include "trees.h"
+
+#define FROZEN_MAX_HEIGHT 32   // height of the implicit tree of 2^31 - 1 keys
+
+/**
+ * Enum to represent the order
+ * of keys in the array of a frozen tree
+ */
+enum frozenLayout {
+    EYTZINGER,      // breadth first: children of slot k are 2k and 2k + 1
+    VAN_EMDE_BOAS   // recursive: top half of the tree, then each bottom subtree
+};
+
+/**
+ * Structure to represent a frozen tree:
+ * the keys of a tree in one array, the tree shape is implicit.
+ * Values point into the nodes of the frozen tree, so it is valid
+ * until that tree changes.
+ */
+struct frozen
+{
+    enum frozenLayout layout;
+    int size;               // number of slots
+    int height;             // height of the implicit tree
+    int *keys;              // keys array, aligned to a cache line
+    const char **values;    // data of each key, NULL for padding slots
+    void *memory;           // allocated keys array, NULL if not frozen
+    // van Emde Boas layout, for each depth d of a subtree root:
+    int top_depth[FROZEN_MAX_HEIGHT];   // depth of the root of the top tree above it
+    int top_size[FROZEN_MAX_HEIGHT];    // nodes of that top tree
+    int bottom_size[FROZEN_MAX_HEIGHT]; // nodes of the bottom subtree rooted at d
+};
+
+void frozen_init(struct frozen *frozen);
+void avl_freeze(struct frozen *frozen, struct avl_node *root, enum frozenLayout layout);
+void rbt_freeze(struct frozen *frozen, struct rbt_node *root, enum frozenLayout layout);
+const char* frozen_find(const struct frozen *frozen, int key);
+void frozen_free(struct frozen *frozen);
+
+/**
+ * Check if a tree is frozen
+ * @param frozen frozen tree
+ * @return 1 if frozen holds a copy of a tree
+ */
+static inline int frozen_is_frozen(const struct frozen *frozen)
+{
+    return frozen->memory != NULL;
+}
+
+#endif //FROZEN_TREES_H
@@ -0,0 +1,488 @@
+//
+// Binary trees on a node pool: 32-bit indices instead of pointers
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trees.h"
+#include "index_trees.h"
+
+/*************************
+ *  Pool
+ *************************/
+
+/**
+ * Initialize a pool with room for capacity nodes
+ * @param pool pool to initialize
+ * @param capacity initial number of nodes
+ */
+void ix_pool_init(struct ix_pool *pool, uint32_t capacity)
+{
+    if (capacity < 2)
+        capacity = 2;
+    pool->nodes = (struct ix_node *) malloc(capacity * sizeof(ix_node));
+    if (pool->nodes == NULL)
+    {
+        fprintf (stderr, "create node pool fail\n");
+        exit(1);
+    }
+    // sentinel: no children, black, parent is itself
+    memset(&pool->nodes[IX_NIL], 0, sizeof(ix_node));
+    pool->count = 1;
+    pool->capacity = capacity;
+    arena_init(&pool->strings, ARENA_SLAB_SIZE);
+}
+
+/**
+ * Get a new node from the pool, the array doubles when full
+ * Pointers to nodes are not valid anymore after this call, indices are.
+ * @param pool pool to allocate from
+ * @return index of the new node
+ */
+uint32_t ix_pool_alloc(struct ix_pool *pool)
+{
+    if (pool->count == pool->capacity)
+    {
+        struct ix_node *nodes;
+        nodes = (struct ix_node *) realloc(pool->nodes, 2 * (size_t) pool->capacity * sizeof(ix_node));
+        if (nodes == NULL)
+        {
+            fprintf (stderr, "grow node pool fail\n");
+            exit(1);
+        }
+        pool->nodes = nodes;
+        pool->capacity *= 2;
+    }
+    return pool->count++;
+}
+
+/**
+ * Remove all nodes from the pool in O(1), memory is kept
+ * @param pool pool to clear
+ */
+void ix_pool_clear(struct ix_pool *pool)
+{
+    pool->count = 1;
+    arena_clear(&pool->strings);
+}
+
+/**
+ * Give back the pool memory to the system
+ * @param pool pool to free
+ */
+void ix_pool_free(struct ix_pool *pool)
+{
+    free(pool->nodes);
+    pool->nodes = NULL;
+    pool->count = 0;
+    pool->capacity = 0;
+    arena_free(&pool->strings);
+}
+
+/**
+ * Create a new node in the pool
+ * @param pool pool to allocate from
+ * @param key node key
+ * @param data node value
+ * @return index of the new node
+ */
+static uint32_t ix_create(struct ix_pool *pool, int key, char *data)
+{
+    uint32_t index = ix_pool_alloc(pool);
+    struct ix_node *node = &pool->nodes[index];
+    node->key = key;
+    node->left = IX_NIL;
+    node->right = IX_NIL;
+    node->meta = 0;
+    payload_set(&node->data, &pool->strings, data);
+    return index;
+}
+
+/**
+ * Search a node with key and, if found, return its value
+ * Same search for BST, AVL and RBT.
+ * @param pool pool of the tree
+ * @param root tree root
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+static const char* ix_find(struct ix_pool *pool, uint32_t root, int key)
+{
+    struct ix_node *nodes = pool->nodes;
+    while (root != IX_NIL) {
+        if (nodes[root].key == key)
+            return payload_get(&nodes[root].data);
+        if (nodes[root].key < key)
+            root = nodes[root].right;
+        else
+            root = nodes[root].left;
+    }
+    return NULL;
+}
+
+
+/*************************
+ *  BST
+ *************************/
+
+/**
+ * Insert new node in a BST
+ * @param pool pool of the tree
+ * @param root BST root
+ * @param key key to insert
+ * @param data value to insert
+ * @return BST root
+ */
+uint32_t bst_ix_insert(struct ix_pool *pool, uint32_t root, int key, char *data)
+{
+    // allocate first: the pool may move while growing
+    uint32_t index = ix_create(pool, key, data);
+    struct ix_node *nodes = pool->nodes;
+    uint32_t *link = &root;
+
+    // Traverse to the right place and insert the node
+    while (*link != IX_NIL) {
+        if (key < nodes[*link].key)
+            link = &nodes[*link].left;
+        else
+            link = &nodes[*link].right;
+    }
+    *link = index;
+
+    return root;
+}
+
+/**
+ * Search a node with key in a BST
+ * @param pool pool of the tree
+ * @param root BST root
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* bst_ix_find(struct ix_pool *pool, uint32_t root, int key)
+{
+    return ix_find(pool, root, key);
+}
+
+
+/*************************
+ *  AVL
+ *************************/
+
+/**
+ * Get the height of the node, 0 for the sentinel
+ */
+#define IX_HEIGHT(nodes, i) ((i) == IX_NIL ? 0 : (int) (nodes)[i].meta)
+
+/**
+ * Update height of a node from its children
+ * @param nodes pool array
+ * @param i node index
+ */
+static inline void avl_ix_update(struct ix_node *nodes, uint32_t i)
+{
+    int left = IX_HEIGHT(nodes, nodes[i].left);
+    int right = IX_HEIGHT(nodes, nodes[i].right);
+    nodes[i].meta = (uint32_t) (1 + ((left > right) ? left : right));
+}
+
+/**
+ * Right rotate AVL subtree rooted with root
+ * @param nodes pool array
+ * @param root subtree root
+ * @return rotated subtree root
+ */
+static uint32_t avl_ix_right_rotate(struct ix_node *nodes, uint32_t root)
+{
+    uint32_t x = nodes[root].left;
+    nodes[root].left = nodes[x].right;
+    nodes[x].right = root;
+    avl_ix_update(nodes, root);
+    avl_ix_update(nodes, x);
+    return x;
+}
+
+/**
+ * Left rotate AVL subtree rooted with root
+ * @param nodes pool array
+ * @param root subtree root
+ * @return rotated subtree root
+ */
+static uint32_t avl_ix_left_rotate(struct ix_node *nodes, uint32_t root)
+{
+    uint32_t y = nodes[root].right;
+    nodes[root].right = nodes[y].left;
+    nodes[y].left = root;
+    avl_ix_update(nodes, root);
+    avl_ix_update(nodes, y);
+    return y;
+}
+
+/**
+ * Insert new node in an AVL
+ * Same algorithm of avl_insert on indices.
+ * @param pool pool of the tree
+ * @param root AVL root
+ * @param key key to insert
+ * @param data value to insert
+ * @return AVL root
+ */
+uint32_t avl_ix_insert(struct ix_pool *pool, uint32_t root, int key, char *data)
+{
+    // allocate first: the pool may move while growing
+    uint32_t index = ix_create(pool, key, data);
+    struct ix_node *nodes = pool->nodes;
+    nodes[index].meta = 1;
+
+    uint32_t *path[AVL_MAX_HEIGHT];
+    int depth = 0;
+    uint32_t *link = &root;
+
+    // Traverse to the right place and insert the node
+    while (*link != IX_NIL) {
+        if (key == nodes[*link].key) {
+            // Equal keys are not allowed in AVL: give back the new node, the last of the pool
+            pool->count--;
+            return root;
+        }
+        path[depth++] = link;
+        if (key < nodes[*link].key)
+            link = &nodes[*link].left;
+        else
+            link = &nodes[*link].right;
+    }
+    *link = index;
+
+    while (depth > 0) {
+        link = path[--depth];
+        uint32_t parent = *link;
+        int old_height = (int) nodes[parent].meta;
+
+        avl_ix_update(nodes, parent);
+        int balance = IX_HEIGHT(nodes, nodes[parent].left) - IX_HEIGHT(nodes, nodes[parent].right);
+
+        // Left Left and Left Right Cases
+        if (balance > 1) {
+            if (key > nodes[nodes[parent].left].key)
+                nodes[parent].left = avl_ix_left_rotate(nodes, nodes[parent].left);
+            *link = avl_ix_right_rotate(nodes, parent);
+        }
+        // Right Right and Right Left Cases
+        else if (balance < -1) {
+            if (key < nodes[nodes[parent].right].key)
+                nodes[parent].right = avl_ix_right_rotate(nodes, nodes[parent].right);
+            *link = avl_ix_left_rotate(nodes, parent);
+        }
+
+        // Subtree height unchanged: nodes above are still balanced
+        if ((int) nodes[*link].meta == old_height)
+            break;
+    }
+
+    return root;
+}
+
+/**
+ * Search a node with key in an AVL
+ * @param pool pool of the tree
+ * @param root AVL root
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* avl_ix_find(struct ix_pool *pool, uint32_t root, int key)
+{
+    return ix_find(pool, root, key);
+}
+
+
+/*************************
+ *  RBT
+ *************************/
+
+/**
+ * Accessors of parent index and color, packed in meta
+ */
+static inline uint32_t ix_parent(struct ix_node *nodes, uint32_t i)
+{
+    return nodes[i].meta >> 1;
+}
+
+static inline enum nodeColor ix_color(struct ix_node *nodes, uint32_t i)
+{
+    return (enum nodeColor) (nodes[i].meta & 1);
+}
+
+static inline void ix_set_parent(struct ix_node *nodes, uint32_t i, uint32_t parent)
+{
+    nodes[i].meta = (parent << 1) | (nodes[i].meta & 1);
+}
+
+static inline void ix_set_color(struct ix_node *nodes, uint32_t i, enum nodeColor color)
+{
+    nodes[i].meta = (nodes[i].meta & ~1u) | (uint32_t) color;
+}
+
+/**
+ * Left rotate RBT subtree rooted with x
+ * @param nodes pool array
+ * @param root RBT root
+ * @param x node to rotate
+ * @return RBT root
+ */
+static uint32_t rbt_ix_left_rotate(struct ix_node *nodes, uint32_t root, uint32_t x)
+{
+    uint32_t y = nodes[x].right;
+    uint32_t parent = ix_parent(nodes, x);
+    nodes[x].right = nodes[y].left;
+    if (nodes[y].left != IX_NIL)
+        ix_set_parent(nodes, nodes[y].left, x);
+    ix_set_parent(nodes, y, parent);
+    if (parent == IX_NIL)
+        root = y;
+    else if (x == nodes[parent].left)
+        nodes[parent].left = y;
+    else
+        nodes[parent].right = y;
+    nodes[y].left = x;
+    ix_set_parent(nodes, x, y);
+    return root;
+}
+
+/**
+ * Right rotate RBT subtree rooted with y
+ * @param nodes pool array
+ * @param root RBT root
+ * @param y node to rotate
+ * @return RBT root
+ */
+static uint32_t rbt_ix_right_rotate(struct ix_node *nodes, uint32_t root, uint32_t y)
+{
+    uint32_t x = nodes[y].left;
+    uint32_t parent = ix_parent(nodes, y);
+    nodes[y].left = nodes[x].right;
+    if (nodes[x].right != IX_NIL)
+        ix_set_parent(nodes, nodes[x].right, y);
+    ix_set_parent(nodes, x, parent);
+    if (parent == IX_NIL)
+        root = x;
+    else if (y == nodes[parent].right)
+        nodes[parent].right = x;
+    else
+        nodes[parent].left = x;
+    nodes[x].right = y;
+    ix_set_parent(nodes, y, x);
+    return root;
+}
+
+/**
+ * Resort the Red-Black tree properties after an insert
+ * Same cases of fixup on indices.
+ * @param nodes pool array
+ * @param root RBT root
+ * @param node inserted node
+ * @return RBT root
+ */
+static uint32_t rbt_ix_fixup(struct ix_node *nodes, uint32_t root, uint32_t node)
+{
+    while (ix_color(nodes, ix_parent(nodes, node)) == RED)
+    {
+        uint32_t parent = ix_parent(nodes, node);
+        uint32_t grandparent = ix_parent(nodes, parent);
+        if (parent == nodes[grandparent].left)
+        {
+            uint32_t uncle = nodes[grandparent].right;
+            if (ix_color(nodes, uncle) == RED)
+            {
+                ix_set_color(nodes, parent, BLACK);
+                ix_set_color(nodes, uncle, BLACK);
+                ix_set_color(nodes, grandparent, RED);
+                node = grandparent;
+            }
+            else {
+                if (node == nodes[parent].right)
+                {
+                    node = parent;
+                    root = rbt_ix_left_rotate(nodes, root, node);
+                    parent = ix_parent(nodes, node);
+                }
+                ix_set_color(nodes, parent, BLACK);
+                ix_set_color(nodes, grandparent, RED);
+                root = rbt_ix_right_rotate(nodes, root, grandparent);
+            }
+        }
+        else
+        {
+            uint32_t uncle = nodes[grandparent].left;
+            if (ix_color(nodes, uncle) == RED)
+            {
+                ix_set_color(nodes, parent, BLACK);
+                ix_set_color(nodes, uncle, BLACK);
+                ix_set_color(nodes, grandparent, RED);
+                node = grandparent;
+            }
+            else {
+                if (node == nodes[parent].left)
+                {
+                    node = parent;
+                    root = rbt_ix_right_rotate(nodes, root, node);
+                    parent = ix_parent(nodes, node);
+                }
+                ix_set_color(nodes, parent, BLACK);
+                ix_set_color(nodes, grandparent, RED);
+                root = rbt_ix_left_rotate(nodes, root, grandparent);
+            }
+        }
+    }
+    ix_set_color(nodes, root, BLACK);
+    return root;
+}
+
+/**
+ * Insert new node in a RBT
+ * @param pool pool of the tree
+ * @param root RBT root
+ * @param key key to insert
+ * @param data value to insert
+ * @return RBT root
+ */
+uint32_t rbt_ix_insert(struct ix_pool *pool, uint32_t root, int key, char *data)
+{
+    // allocate first: the pool may move while growing
+    uint32_t z = ix_create(pool, key, data);
+    struct ix_node *nodes = pool->nodes;
+    uint32_t y = IX_NIL;
+    uint32_t x = root;
+
+    // Find where to Insert new node z into the RBT
+    while (x != IX_NIL) {
+        y = x;
+        if (key < nodes[x].key)
+            x = nodes[x].left;
+        else
+            x = nodes[x].right;
+    }
+
+    // Init z as a red leaf
+    nodes[z].meta = (y << 1) | RED;
+    if (y == IX_NIL)
+        root = z;
+    else if (key < nodes[y].key)
+        nodes[y].left = z;
+    else
+        nodes[y].right = z;
+
+    // Ensure the Red-Black property is maintained
+    return rbt_ix_fixup(nodes, root, z);
+}
+
+/**
+ * Search a node with key in a RBT
+ * @param pool pool of the tree
+ * @param root RBT root
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* rbt_ix_find(struct ix_pool *pool, uint32_t root, int key)
+{
+    return ix_find(pool, root, key);
+}
@@ -0,0 +1,53 @@
+//
+// Binary trees on a node pool: 32-bit indices instead of pointers
+//
+#ifndef INDEX_TREES_H
+#define INDEX_TREES_H
+
+#include <stdint.h>
+#include "arena.h"
+#include "payload.h"
+
+#define IX_NIL 0   // index of the sentinel node, the empty tree
+
+/**
+ * Structure to represent each node of a pool
+ * Children are indices in the pool array. meta holds the height of
+ * an AVL node, or parent index and color (lowest bit) of a RBT node.
+ */
+typedef struct ix_node
+{
+    int key;
+    uint32_t left;
+    uint32_t right;
+    uint32_t meta;
+    struct payload data;
+} ix_node;
+
+/**
+ * Structure to represent a pool of nodes:
+ * one growable array, node 0 is the sentinel
+ */
+struct ix_pool
+{
+    struct ix_node *nodes;
+    uint32_t count;         // nodes in use, sentinel included
+    uint32_t capacity;      // nodes allocated
+    struct arena strings;   // long data strings
+};
+
+void ix_pool_init(struct ix_pool *pool, uint32_t capacity);
+uint32_t ix_pool_alloc(struct ix_pool *pool);
+void ix_pool_clear(struct ix_pool *pool);
+void ix_pool_free(struct ix_pool *pool);
+
+uint32_t bst_ix_insert(struct ix_pool *pool, uint32_t root, int key, char *data);
+const char* bst_ix_find(struct ix_pool *pool, uint32_t root, int key);
+
+uint32_t avl_ix_insert(struct ix_pool *pool, uint32_t root, int key, char *data);
+const char* avl_ix_find(struct ix_pool *pool, uint32_t root, int key);
+
+uint32_t rbt_ix_insert(struct ix_pool *pool, uint32_t root, int key, char *data);
+const char* rbt_ix_find(struct ix_pool *pool, uint32_t root, int key);
+
+#endif //INDEX_TREES_H
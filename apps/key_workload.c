@@ -0,0 +1,296 @@
+//
+// Key workloads: keys of the benchmarks, generated ahead of the measures
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "key_workload.h"
+#include "reader.h"
+
+/**
+ * Initialize a workload of uniform random keys
+ * @param workload workload to initialize
+ */
+void key_workload_init(struct key_workload *workload)
+{
+    workload->distribution = KEYS_UNIFORM;
+    workload->parameter = 0;
+    workload->hot_share = 0;
+    workload->trace = NULL;
+    workload->trace_size = 0;
+    workload->cdf = NULL;
+    workload->cdf_size = 0;
+}
+
+/**
+ * Free the trace and the Zipf table of a workload, it draws uniform keys again
+ * @param workload workload to free
+ */
+void key_workload_free(struct key_workload *workload)
+{
+    free(workload->trace);
+    free(workload->cdf);
+    key_workload_init(workload);
+}
+
+/**
+ * Append the keys of the insert, find and delete commands of a file to the trace
+ * The file is a command file of bst, avl, rbt and btree.
+ * @param workload trace workload
+ * @param file name of the file
+ * @return 0 if the file cannot be opened
+ */
+static int trace_read(struct key_workload *workload, const char *file)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct reader reader;
+    char *cmd;
+    char *data;
+    int key;
+    int capacity = 0;
+    reader_init(&reader, fd);
+    while (reader_next(&reader, &cmd, &key, &data)) {
+        if (strcmp(cmd, "insert") != 0 && strcmp(cmd, "find") != 0 && strcmp(cmd, "delete") != 0)
+            continue;
+        if (workload->trace_size == capacity) {
+            capacity = capacity ? 2 * capacity : 1024;
+            workload->trace = (int *) realloc(workload->trace, capacity * sizeof(int));
+            if (workload->trace == NULL)
+            {
+                fprintf (stderr, "create trace fail\n");
+                exit(1);
+            }
+        }
+        workload->trace[workload->trace_size++] = key;
+    }
+    reader_free(&reader);
+    close(fd);
+    return 1;
+}
+
+/**
+ * Parse a number of a workload specification
+ * @param text number, NULL if not given
+ * @param number parsed number, unchanged if not given
+ * @param min smallest valid number
+ * @param max biggest valid number
+ * @return 0 if the number is not valid
+ */
+static int parse_number(const char *text, double *number, double min, double max)
+{
+    if (text == NULL)
+        return 1;
+    char *end;
+    double value = strtod(text, &end);
+    if (*text == '\0' || (*end != '\0' && *end != ':') || !(value >= min && value <= max))
+        return 0;
+    *number = value;
+    return 1;
+}
+
+/**
+ * Set a workload from its specification: uniform, sequential, reverse,
+ * nearly[:FRACTION], zipf[:S], hotset[:FRACTION[:SHARE]] or trace:FILE
+ * @param workload workload to set, its previous trace is freed
+ * @param spec specification of the workload
+ * @return 0 if the specification is not valid or the trace cannot be read
+ */
+int key_workload_parse(struct key_workload *workload, const char *spec)
+{
+    const char *names[] = { "uniform", "sequential", "reverse", "nearly", "zipf", "hotset", "trace" };
+    size_t length = strcspn(spec, ":");
+    const char *first = spec[length] == ':' ? spec + length + 1 : NULL;
+    const char *second = first != NULL && strchr(first, ':') != NULL ? strchr(first, ':') + 1 : NULL;
+    int d;
+
+    for (d = 0; d <= KEYS_TRACE; d++)
+        if (strlen(names[d]) == length && strncmp(spec, names[d], length) == 0)
+            break;
+    if (d > KEYS_TRACE)
+        return 0;
+    key_workload_free(workload);
+    workload->distribution = (enum keyDistribution) d;
+
+    switch (workload->distribution) {
+        case KEYS_NEARLY_SORTED:
+            workload->parameter = KEY_WORKLOAD_NEARLY_SORTED;
+            return second == NULL && parse_number(first, &workload->parameter, 0, 1);
+        case KEYS_ZIPF:
+            workload->parameter = KEY_WORKLOAD_ZIPF;
+            return second == NULL && parse_number(first, &workload->parameter, 1e-9, 100);
+        case KEYS_HOT_SET:
+            workload->parameter = KEY_WORKLOAD_HOT_KEYS;
+            workload->hot_share = KEY_WORKLOAD_HOT_SHARE;
+            return parse_number(first, &workload->parameter, 1e-9, 1)
+                   && (second == NULL || strchr(second, ':') == NULL)
+                   && parse_number(second, &workload->hot_share, 0, 1);
+        case KEYS_TRACE:
+            if (first == NULL || !trace_read(workload, first) || workload->trace_size == 0) {
+                key_workload_free(workload);
+                return 0;
+            }
+            return 1;
+        default:
+            return first == NULL;
+    }
+}
+
+/**
+ * Check if the keys of a workload come almost in order, the worst case of a BST
+ * @param workload workload
+ * @return 1 for sequential, reverse and nearly sorted keys
+ */
+int key_workload_sorted(const struct key_workload *workload)
+{
+    return workload->distribution == KEYS_SEQUENTIAL || workload->distribution == KEYS_REVERSE
+           || workload->distribution == KEYS_NEARLY_SORTED;
+}
+
+/**
+ * Get the key of the i-th distinct key of a workload
+ * Multiplying by an odd number is a bijection modulo 2^32: distinct
+ * indices give distinct keys, spread over the whole keys space.
+ * @param i index of the key
+ * @return key
+ */
+static int spread_key(int i)
+{
+    return (int) ((uint32_t) i * 2654435761u);
+}
+
+/**
+ * Fill an array with increasing keys from INT_MIN, random gaps between them
+ * Gaps are smaller for big n, so that keys never wrap around.
+ * @param prng generator of the gaps
+ * @param keys keys to fill
+ * @param n number of keys
+ */
+static void fill_sorted(struct prng *prng, int *keys, int n)
+{
+    uint32_t gap = KEY_WORKLOAD_GAP;
+    if (n > 0 && UINT32_MAX / (uint32_t) n < gap)
+        gap = UINT32_MAX / (uint32_t) n;
+    uint32_t key = 0;
+    for (int i = 0; i < n; i++) {
+        key += 1 + prng_below(prng, gap);
+        // flipping the sign bit keeps the order of unsigned keys as ints
+        keys[i] = (int) (key ^ 0x80000000u);
+    }
+}
+
+/**
+ * Build the cumulative probabilities of n Zipf ranks, unless already built
+ * @param workload Zipf workload
+ * @param n number of ranks
+ */
+static void zipf_table(struct key_workload *workload, int n)
+{
+    if (workload->cdf_size == n)
+        return;
+    free(workload->cdf);
+    workload->cdf = (double *) malloc(n * sizeof(double));
+    if (workload->cdf == NULL)
+    {
+        fprintf (stderr, "create Zipf table fail\n");
+        exit(1);
+    }
+    workload->cdf_size = n;
+    double sum = 0;
+    for (int r = 0; r < n; r++) {
+        sum += 1.0 / pow((double) (r + 1), workload->parameter);
+        workload->cdf[r] = sum;
+    }
+    for (int r = 0; r < n; r++)
+        workload->cdf[r] /= sum;
+}
+
+/**
+ * Draw a Zipf rank, by binary search of the cumulative probabilities
+ * @param workload Zipf workload, its table built
+ * @param prng generator of the draw
+ * @return rank from 0, the most frequent one
+ */
+static int zipf_rank(const struct key_workload *workload, struct prng *prng)
+{
+    double u = prng_fraction(prng);
+    int low = 0;
+    int high = workload->cdf_size - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (workload->cdf[middle] > u)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return low;
+}
+
+/**
+ * Fill an array with the keys of a workload
+ * Keys are drawn here, ahead of the measure, so drawing them is not measured.
+ * Zipf and hot set keys are drawn among n distinct keys, trace keys are
+ * replayed from the first one, again when the trace is shorter than n.
+ * @param workload workload to draw from
+ * @param prng generator of the keys
+ * @param keys keys to fill
+ * @param n number of keys
+ */
+void key_workload_fill(struct key_workload *workload, struct prng *prng, int *keys, int n)
+{
+    switch (workload->distribution) {
+        case KEYS_SEQUENTIAL:
+            fill_sorted(prng, keys, n);
+            break;
+        case KEYS_REVERSE:
+            fill_sorted(prng, keys, n);
+            for (int i = 0; i < n / 2; i++) {
+                int key = keys[i];
+                keys[i] = keys[n - 1 - i];
+                keys[n - 1 - i] = key;
+            }
+            break;
+        case KEYS_NEARLY_SORTED:
+            fill_sorted(prng, keys, n);
+            // each swap puts two keys out of place
+            for (int s = 0; s < (int) (workload->parameter * n / 2); s++) {
+                int i = (int) prng_below(prng, n);
+                int j = (int) prng_below(prng, n);
+                int key = keys[i];
+                keys[i] = keys[j];
+                keys[j] = key;
+            }
+            break;
+        case KEYS_ZIPF:
+            zipf_table(workload, n);
+            for (int i = 0; i < n; i++)
+                keys[i] = spread_key(zipf_rank(workload, prng));
+            break;
+        case KEYS_HOT_SET: {
+            int hot = (int) (workload->parameter * n);
+            if (hot < 1)
+                hot = 1;
+            for (int i = 0; i < n; i++) {
+                if (hot == n || prng_fraction(prng) < workload->hot_share)
+                    keys[i] = spread_key((int) prng_below(prng, hot));
+                else
+                    keys[i] = spread_key(hot + (int) prng_below(prng, n - hot));
+            }
+            break;
+        }
+        case KEYS_TRACE:
+            for (int i = 0; i < n; i++)
+                keys[i] = workload->trace[i % workload->trace_size];
+            break;
+        default:
+            // the whole keys space, negative keys included
+            for (int i = 0; i < n; i++)
+                keys[i] = (int) prng_u32(prng);
+    }
+}
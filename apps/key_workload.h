@@ -0,0 +1,51 @@
+//
+// Key workloads: keys of the benchmarks, generated ahead of the measures
+//
+#ifndef KEY_WORKLOAD_H
+#define KEY_WORKLOAD_H
+
+#include "prng.h"
+
+#define KEY_WORKLOAD_GAP 2048             // sorted keys grow by 1 to KEY_WORKLOAD_GAP, less when they would wrap
+#define KEY_WORKLOAD_NEARLY_SORTED 0.05   // default fraction of nearly sorted keys out of place
+#define KEY_WORKLOAD_ZIPF 0.99            // default exponent of Zipf keys
+#define KEY_WORKLOAD_HOT_KEYS 0.1         // default fraction of hot set keys that are hot
+#define KEY_WORKLOAD_HOT_SHARE 0.9        // default fraction of hot set operations on hot keys
+
+/**
+ * Enum to represent how
+ * the keys of a workload are drawn
+ */
+enum keyDistribution {
+    KEYS_UNIFORM,       // random keys of the whole int range
+    KEYS_SEQUENTIAL,    // increasing keys from INT_MIN, random gaps
+    KEYS_REVERSE,       // decreasing keys, random gaps
+    KEYS_NEARLY_SORTED, // increasing keys, some swapped with random other ones
+    KEYS_ZIPF,          // n distinct keys, the one of rank r drawn with probability ~ 1 / r^s
+    KEYS_HOT_SET,       // n distinct keys, a few hot ones get most of the draws
+    KEYS_TRACE          // keys of the commands of a file, in order
+};
+
+/**
+ * Structure to represent a key workload
+ * Keys that are not sorted are spread over the keys space, so the shape of
+ * a tree does not depend on the distribution but on its order.
+ */
+struct key_workload
+{
+    enum keyDistribution distribution;
+    double parameter;   // nearly sorted: keys out of place, Zipf: exponent, hot set: hot keys (fractions of n)
+    double hot_share;   // hot set: fraction of draws on hot keys
+    int *trace;         // trace: keys of the commands
+    int trace_size;     // trace: number of keys
+    double *cdf;        // Zipf: cumulative probability of each rank, kept for the next draws
+    int cdf_size;       // Zipf: number of ranks of cdf
+};
+
+void key_workload_init(struct key_workload *workload);
+int key_workload_parse(struct key_workload *workload, const char *spec);
+int key_workload_sorted(const struct key_workload *workload);
+void key_workload_fill(struct key_workload *workload, struct prng *prng, int *keys, int n);
+void key_workload_free(struct key_workload *workload);
+
+#endif //KEY_WORKLOAD_H
@@ -0,0 +1,107 @@
+//
+// Buffered output
+//
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "output.h"
+
+/* Output buffer, written to stdout with large write calls */
+static char buffer[OUTPUT_BUFFER_SIZE];
+static size_t used = 0;
+static enum outputFlush flush_mode = FLUSH_COMMAND;
+
+/**
+ * Initialize the output layer
+ * The buffer is flushed at exit in any mode.
+ * @param mode when to flush the buffer
+ */
+void output_init(enum outputFlush mode)
+{
+    flush_mode = mode;
+    used = 0;
+    atexit(output_flush);
+}
+
+/**
+ * Write the whole buffer to stdout
+ */
+void output_flush(void)
+{
+    size_t written = 0;
+    while (written < used) {
+        ssize_t count = write(STDOUT_FILENO, buffer + written, used - written);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        written += count;
+    }
+    used = 0;
+}
+
+/**
+ * Append a character to the output
+ * @param c character
+ */
+void output_char(char c)
+{
+    if (used == OUTPUT_BUFFER_SIZE)
+        output_flush();
+    buffer[used++] = c;
+}
+
+/**
+ * Append a string to the output
+ * @param s string
+ */
+void output_string(const char *s)
+{
+    size_t length = strlen(s);
+    while (length > 0) {
+        if (used == OUTPUT_BUFFER_SIZE)
+            output_flush();
+        size_t chunk = OUTPUT_BUFFER_SIZE - used;
+        if (chunk > length)
+            chunk = length;
+        memcpy(buffer + used, s, chunk);
+        used += chunk;
+        s += chunk;
+        length -= chunk;
+    }
+}
+
+/**
+ * Append the decimal representation of an integer to the output
+ * @param value integer
+ */
+void output_int(int value)
+{
+    char digits[12];
+    int i = sizeof(digits);
+    // work on the unsigned magnitude, so INT_MIN does not overflow
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int) value : (unsigned int) value;
+
+    do {
+        digits[--i] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+        digits[--i] = '-';
+
+    if (used + (sizeof(digits) - i) > OUTPUT_BUFFER_SIZE)
+        output_flush();
+    memcpy(buffer + used, digits + i, sizeof(digits) - i);
+    used += sizeof(digits) - i;
+}
+
+/**
+ * Mark the end of a command: flush the buffer if flushing on every command
+ */
+void output_end_command(void)
+{
+    if (flush_mode == FLUSH_COMMAND)
+        output_flush();
+}
@@ -0,0 +1,25 @@
+//
+// Buffered output
+//
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#define OUTPUT_BUFFER_SIZE 1048576   // bytes written to stdout at once
+
+/**
+ * Enum to represent when
+ * the output buffer is written to stdout
+ */
+enum outputFlush {
+    FLUSH_COMMAND,  // at the end of every command, and when the buffer is full
+    FLUSH_FULL      // only when the buffer is full and at exit
+};
+
+void output_init(enum outputFlush mode);
+void output_char(char c);
+void output_string(const char *s);
+void output_int(int value);
+void output_end_command(void);
+void output_flush(void);
+
+#endif //OUTPUT_H
@@ -0,0 +1,173 @@
+//
+// Key and data pairs, input of bulk loads
+//
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pairs.h"
+#include "reader.h"
+
+#define PAIRS_FIRST_CAPACITY 1024   // pairs allocated by the first pairs_add
+
+/**
+ * Initialize an empty list of pairs, no memory is allocated until the first pairs_add
+ * @param pairs list to initialize
+ */
+void pairs_init(struct pairs *pairs)
+{
+    pairs->count = 0;
+    pairs->capacity = 0;
+    pairs->keys = NULL;
+    pairs->offsets = NULL;
+    pairs->strings = NULL;
+    pairs->strings_size = 0;
+    pairs->strings_capacity = 0;
+}
+
+/**
+ * Append a pair to the list, arrays double in size when full
+ * @param pairs list of pairs
+ * @param key key of the pair
+ * @param data data of the pair, copied
+ */
+void pairs_add(struct pairs *pairs, int key, const char *data)
+{
+    size_t length = strlen(data) + 1;
+
+    if (pairs->count == pairs->capacity) {
+        pairs->capacity = (pairs->capacity == 0) ? PAIRS_FIRST_CAPACITY : 2 * pairs->capacity;
+        pairs->keys = (int *) realloc(pairs->keys, pairs->capacity * sizeof(int));
+        pairs->offsets = (size_t *) realloc(pairs->offsets, pairs->capacity * sizeof(size_t));
+        if (pairs->keys == NULL || pairs->offsets == NULL)
+        {
+            fprintf (stderr, "create pairs fail\n");
+            exit(1);
+        }
+    }
+    if (pairs->strings_size + length > pairs->strings_capacity) {
+        while (pairs->strings_size + length > pairs->strings_capacity)
+            pairs->strings_capacity = (pairs->strings_capacity == 0) ? 16 * PAIRS_FIRST_CAPACITY
+                                                                      : 2 * pairs->strings_capacity;
+        pairs->strings = (char *) realloc(pairs->strings, pairs->strings_capacity);
+        if (pairs->strings == NULL)
+        {
+            fprintf (stderr, "create pairs fail\n");
+            exit(1);
+        }
+    }
+
+    pairs->keys[pairs->count] = key;
+    pairs->offsets[pairs->count] = pairs->strings_size;
+    memcpy(pairs->strings + pairs->strings_size, data, length);
+    pairs->strings_size += length;
+    pairs->count++;
+}
+
+/**
+ * Append the pairs of a file, one "key data" pair per line
+ * @param pairs list of pairs
+ * @param file name of the file
+ * @return 0 if the file cannot be opened
+ */
+int pairs_read(struct pairs *pairs, const char *file)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct reader reader;
+    reader_init(&reader, fd);
+    int key;
+    char *data;
+    while (reader_next_pair(&reader, &key, &data))
+        pairs_add(pairs, key, data);
+    reader_free(&reader);
+    close(fd);
+    return 1;
+}
+
+/**
+ * Check if pairs are sorted by key, equal keys are allowed
+ * @param pairs list of pairs
+ * @return 1 if keys never decrease
+ */
+int pairs_sorted(const struct pairs *pairs)
+{
+    for (int i = 1; i < pairs->count; i++) {
+        if (pairs->keys[i] < pairs->keys[i - 1])
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Sort pairs by key, pairs with equal keys keep their order
+ * Bottom-up merge sort: runs of width 1, 2, 4... are merged into a
+ * second pair of arrays, then the arrays are swapped.
+ * @param pairs list of pairs
+ */
+void pairs_sort(struct pairs *pairs)
+{
+    int n = pairs->count;
+    if (pairs_sorted(pairs))
+        return;
+
+    // same capacity, the arrays can end up in the list
+    int *keys = (int *) malloc(pairs->capacity * sizeof(int));
+    size_t *offsets = (size_t *) malloc(pairs->capacity * sizeof(size_t));
+    if (keys == NULL || offsets == NULL)
+    {
+        fprintf (stderr, "create pairs fail\n");
+        exit(1);
+    }
+    for (int width = 1; width < n; width *= 2) {
+        for (int low = 0; low < n; low += 2 * width) {
+            int middle = (low + width < n) ? low + width : n;
+            int high = (low + 2 * width < n) ? low + 2 * width : n;
+            int a = low;
+            int b = middle;
+            for (int i = low; i < high; i++) {
+                // take from the left run on equal keys
+                if (b == high || (a < middle && pairs->keys[a] <= pairs->keys[b])) {
+                    keys[i] = pairs->keys[a];
+                    offsets[i] = pairs->offsets[a++];
+                } else {
+                    keys[i] = pairs->keys[b];
+                    offsets[i] = pairs->offsets[b++];
+                }
+            }
+        }
+        int *swap_keys = pairs->keys;
+        size_t *swap_offsets = pairs->offsets;
+        pairs->keys = keys;
+        pairs->offsets = offsets;
+        keys = swap_keys;
+        offsets = swap_offsets;
+    }
+    free(keys);
+    free(offsets);
+}
+
+/**
+ * Remove all pairs from the list, arrays are kept for next pairs
+ * @param pairs list of pairs
+ */
+void pairs_clear(struct pairs *pairs)
+{
+    pairs->count = 0;
+    pairs->strings_size = 0;
+}
+
+/**
+ * Free the arrays of a list of pairs, the list is empty again
+ * @param pairs list of pairs
+ */
+void pairs_free(struct pairs *pairs)
+{
+    free(pairs->keys);
+    free(pairs->offsets);
+    free(pairs->strings);
+    pairs_init(pairs);
+}
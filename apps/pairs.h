@@ -0,0 +1,43 @@
+//
+// Key and data pairs, input of bulk loads
+//
+#ifndef PAIRS_H
+#define PAIRS_H
+
+#include <stddef.h>
+
+/**
+ * Structure to represent a list of key and data pairs
+ * Data strings are copied one after the other in a single buffer.
+ */
+struct pairs
+{
+    int count;              // number of pairs
+    int capacity;           // pairs that fit in keys and offsets
+    int *keys;              // key of each pair
+    size_t *offsets;        // position of the data of each pair in strings
+    char *strings;          // data strings, each one terminated
+    size_t strings_size;    // bytes used in strings
+    size_t strings_capacity;// bytes allocated for strings
+};
+
+void pairs_init(struct pairs *pairs);
+void pairs_add(struct pairs *pairs, int key, const char *data);
+int pairs_read(struct pairs *pairs, const char *file);
+int pairs_sorted(const struct pairs *pairs);
+void pairs_sort(struct pairs *pairs);
+void pairs_clear(struct pairs *pairs);
+void pairs_free(struct pairs *pairs);
+
+/**
+ * Get data of a pair
+ * @param pairs list of pairs
+ * @param i position of the pair
+ * @return data string
+ */
+static inline char* pairs_data(const struct pairs *pairs, int i)
+{
+    return pairs->strings + pairs->offsets[i];
+}
+
+#endif //PAIRS_H
@@ -0,0 +1,115 @@
+//
+// Command parser throughput: scanLine against the buffered reader
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "trees.h"
+
+#define N_COMMANDS 1000000   // default number of commands to parse
+
+/**
+ * Get elapsed wall clock time
+ * @param start start time
+ * @return seconds from start
+ */
+double elapsed(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double) (end.tv_sec - start->tv_sec) + (double) (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Write n random insert/find commands in a temporary file
+ * @param n number of commands
+ * @return file, rewound
+ */
+FILE* generate_commands(int n) {
+    FILE *file = tmpfile();
+    if (file == NULL)
+    {
+        fprintf (stderr, "create commands file fail\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        if (rand() % 2 == 0)
+            fprintf(file, "insert %d d%d\n", rand(), i % 1000);
+        else
+            fprintf(file, "find %d\n", rand());
+    }
+    fflush(file);
+    rewind(file);
+    return file;
+}
+
+/**
+ * Parse n commands from stdin with scanLine
+ * @param n number of commands
+ * @param sum sum of keys, so parsing can not be optimized away
+ * @return elapsed time in seconds
+ */
+double scanline_time(int n, long *sum) {
+    char command[MAX_CMD_LENGTH];
+    char data[MAX_LINE_SIZE];
+    int key = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++) {
+        scanLine(command, &key, data);
+        *sum += key;
+    }
+    return elapsed(&start);
+}
+
+/**
+ * Parse n commands from a file descriptor with the buffered reader
+ * @param fd file descriptor
+ * @param n number of commands
+ * @param sum sum of keys, so parsing can not be optimized away
+ * @return elapsed time in seconds
+ */
+double reader_time(int fd, int n, long *sum) {
+    struct reader reader;
+    char *command;
+    char *data;
+    int key = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    reader_init(&reader, fd);
+    for (int i = 0; i < n && reader_next(&reader, &command, &key, &data); i++) {
+        *sum += key;
+    }
+    reader_free(&reader);
+    return elapsed(&start);
+}
+
+int main (int argc, char *argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : N_COMMANDS;
+    if (n <= 0)
+        n = N_COMMANDS;
+    srand(1);
+
+    FILE *file = generate_commands(n);
+    long scanline_sum = 0;
+    long reader_sum = 0;
+
+    // scanLine reads stdin: read the commands file from it
+    dup2(fileno(file), STDIN_FILENO);
+    double t_scanline = scanline_time(n, &scanline_sum);
+
+    lseek(fileno(file), 0, SEEK_SET);
+    double t_reader = reader_time(fileno(file), n, &reader_sum);
+
+    if (scanline_sum != reader_sum)
+        fprintf(stderr, "parsers disagree on keys\n");
+
+    // parser, commands, time, commands per second
+    printf("scanLine %d %.6f %.0f\n", n, t_scanline, (double) n / t_scanline);
+    printf("reader %d %.6f %.0f\n", n, t_reader, (double) n / t_reader);
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,48 @@
+//
+// Node payload: short data strings stored inline, long ones out of line
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "payload.h"
+
+/**
+ * Store a data string in a payload
+ * Strings up to PAYLOAD_INLINE_SIZE characters are copied inside the payload,
+ * longer ones are copied in the arena or, without arena, with malloc.
+ * @param payload payload to fill
+ * @param arena arena for long strings, NULL to use malloc
+ * @param data data string
+ */
+void payload_set(struct payload *payload, struct arena *arena, const char *data)
+{
+    size_t length = strlen(data);
+    if (length <= PAYLOAD_INLINE_SIZE)
+    {
+        memcpy(payload->u.small, data, length + 1);
+        payload->u.small[PAYLOAD_INLINE_SIZE] = 0;
+        return;
+    }
+
+    char *large = (arena != NULL) ? arena_strdup(arena, data) : strdup(data);
+    if (large == NULL)
+    {
+        fprintf (stderr, "create payload fail\n");
+        exit(1);
+    }
+    payload->u.large = large;
+    payload->u.small[PAYLOAD_INLINE_SIZE] = 1;
+}
+
+/**
+ * Free an out of line data string allocated with malloc
+ * Payloads in an arena are released with the arena and must not be freed.
+ * @param payload payload to free
+ */
+void payload_free(struct payload *payload)
+{
+    if (payload->u.small[PAYLOAD_INLINE_SIZE] != 0)
+        free(payload->u.large);
+    payload->u.small[0] = 0;
+    payload->u.small[PAYLOAD_INLINE_SIZE] = 0;
+}
@@ -0,0 +1,39 @@
+//
+// Node payload: short data strings stored inline, long ones out of line
+//
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include "arena.h"
+
+#define PAYLOAD_INLINE_SIZE 15   // longest data string stored inside the node
+
+/**
+ * Structure to represent the data of a node
+ * small[PAYLOAD_INLINE_SIZE] is the tag: 0 when the string is inline
+ * (it is also its terminator), 1 when it lives out of line in large.
+ */
+struct payload
+{
+    union {
+        char small[PAYLOAD_INLINE_SIZE + 1];
+        char *large;
+    } u;
+};
+
+void payload_set(struct payload *payload, struct arena *arena, const char *data);
+void payload_free(struct payload *payload);
+
+/**
+ * Get the data string of a payload
+ * @param payload payload to read
+ * @return data string
+ */
+static inline const char* payload_get(const struct payload *payload)
+{
+    if (payload->u.small[PAYLOAD_INLINE_SIZE] == 0)
+        return payload->u.small;
+    return payload->u.large;
+}
+
+#endif //PAYLOAD_H
@@ -0,0 +1,144 @@
+//
+// Hardware performance counters of the process, read with perf_event_open
+//
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* type and config of each counter, see perf_event_open(2) */
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} perf_events[PERF_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+};
+#endif
+
+/**
+ * Open the counters of the calling thread, disabled
+ * Counters are opened one by one: where perf_event_paranoid, a container or a
+ * virtual machine forbids some or all of them, the others still count.
+ * @param counters set of counters to open
+ */
+void perf_counters_open(struct perf_counters *counters)
+{
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        counters->fd[i] = -1;
+        counters->counts[i] = 0;
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf_events[i].type;
+        attr.config = perf_events[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // counters may share the hardware: times let counts be scaled to the whole run
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fd[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters->fd[i] < 0)
+            counters->fd[i] = -1;
+#endif
+    }
+}
+
+/**
+ * Check if a counter counts
+ * @param counters set of counters
+ * @param counter counter to check
+ * @return 1 if the counter was opened, 0 otherwise
+ */
+int perf_counters_available(const struct perf_counters *counters, enum perfCounter counter)
+{
+    return counters->fd[counter] >= 0;
+}
+
+/**
+ * Get the name of a counter
+ * @param counter counter
+ * @return counter name
+ */
+const char* perf_counters_name(enum perfCounter counter)
+{
+    static const char *names[PERF_COUNTERS] = {
+        "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses", "dTLB-misses"
+    };
+    return names[counter];
+}
+
+/**
+ * Set the counts of a set to 0, the next runs are added to them
+ * @param counters set of counters
+ */
+void perf_counters_reset(struct perf_counters *counters)
+{
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        counters->counts[i] = 0;
+}
+
+/**
+ * Start counting from 0 on every available counter
+ * @param counters set of counters
+ */
+void perf_counters_start(struct perf_counters *counters)
+{
+#ifdef __linux__
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        if (counters->fd[i] >= 0) {
+            ioctl(counters->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void) counters;
+#endif
+}
+
+/**
+ * Stop counting and add the events counted since perf_counters_start to the counts
+ * @param counters set of counters
+ */
+void perf_counters_stop(struct perf_counters *counters)
+{
+#ifdef __linux__
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        if (counters->fd[i] >= 0)
+            ioctl(counters->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        uint64_t value[3];  // count, time enabled, time running
+        if (counters->fd[i] < 0 || read(counters->fd[i], value, sizeof(value)) != sizeof(value))
+            continue;
+        if (value[2] > 0)
+            counters->counts[i] += (double) value[0] * (double) value[1] / (double) value[2];
+    }
+#else
+    (void) counters;
+#endif
+}
+
+/**
+ * Close every counter of a set
+ * @param counters set of counters
+ */
+void perf_counters_close(struct perf_counters *counters)
+{
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        if (counters->fd[i] >= 0)
+            close(counters->fd[i]);
+        counters->fd[i] = -1;
+    }
+}
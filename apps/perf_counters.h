@@ -0,0 +1,40 @@
+//
+// Hardware performance counters of the process, read with perf_event_open
+//
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/**
+ * Enum to represent each
+ * counter of a set
+ */
+enum perfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,        // L1 data cache read misses
+    PERF_LLC_MISSES,        // last level cache misses
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,       // data TLB read misses
+    PERF_COUNTERS           // number of counters
+};
+
+/**
+ * Structure to represent a set of counters of the calling thread, user space only
+ * A counter the system does not permit or support has no file descriptor:
+ * its counts stay 0 and it is reported unavailable.
+ */
+struct perf_counters
+{
+    int fd[PERF_COUNTERS];          // file descriptor of each counter, -1 if unavailable
+    double counts[PERF_COUNTERS];   // events counted since perf_counters_reset
+};
+
+void perf_counters_open(struct perf_counters *counters);
+int perf_counters_available(const struct perf_counters *counters, enum perfCounter counter);
+const char* perf_counters_name(enum perfCounter counter);
+void perf_counters_reset(struct perf_counters *counters);
+void perf_counters_start(struct perf_counters *counters);
+void perf_counters_stop(struct perf_counters *counters);
+void perf_counters_close(struct perf_counters *counters);
+
+#endif //PERF_COUNTERS_H
@@ -0,0 +1,72 @@
+//
+// Pseudo random number generator of the benchmarks: xoshiro256**
+//
+#include "prng.h"
+
+/**
+ * Seed a generator
+ * The four state words are drawn from the seed with splitmix64, so close
+ * seeds give unrelated states and the state is never all zero.
+ * @param prng generator to seed
+ * @param seed seed
+ */
+void prng_seed(struct prng *prng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        prng->s[i] = z ^ (z >> 31);
+    }
+}
+
+/**
+ * Move a generator 2^128 numbers ahead, as 2^128 calls to prng_next would
+ * @param prng generator to move
+ */
+void prng_jump(struct prng *prng)
+{
+    static const uint64_t jump[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                     0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+    uint64_t s[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (jump[i] & (uint64_t) 1 << b) {
+                s[0] ^= prng->s[0];
+                s[1] ^= prng->s[1];
+                s[2] ^= prng->s[2];
+                s[3] ^= prng->s[3];
+            }
+            prng_next(prng);
+        }
+    }
+    for (int i = 0; i < 4; i++)
+        prng->s[i] = s[i];
+}
+
+/**
+ * Split an independent stream from a generator, e.g. for a thread
+ * The stream gets the current state, the generator jumps past it.
+ * @param prng generator to split
+ * @param stream new stream
+ */
+void prng_split(struct prng *prng, struct prng *stream)
+{
+    *stream = *prng;
+    prng_jump(prng);
+}
+
+/**
+ * Seed a generator with stream number stream of a seed
+ * The same seed and stream give the same numbers, in any process and thread.
+ * @param prng generator to seed
+ * @param seed seed
+ * @param stream stream number, from 0
+ */
+void prng_stream(struct prng *prng, uint64_t seed, int stream)
+{
+    prng_seed(prng, seed);
+    for (int i = 0; i < stream; i++)
+        prng_jump(prng);
+}
@@ -0,0 +1,94 @@
+//
+// Pseudo random number generator of the benchmarks: xoshiro256**
+//
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+
+/**
+ * Structure to represent the state of a xoshiro256** generator
+ * A generator is not thread safe: every thread draws from its own stream,
+ * split from another generator (streams 2^128 numbers apart never overlap).
+ */
+struct prng
+{
+    uint64_t s[4];
+};
+
+void prng_seed(struct prng *prng, uint64_t seed);
+void prng_jump(struct prng *prng);
+void prng_split(struct prng *prng, struct prng *stream);
+void prng_stream(struct prng *prng, uint64_t seed, int stream);
+
+/**
+ * Rotate a 64-bit number left
+ * @param x number to rotate
+ * @param k number of bits
+ * @return rotated number
+ */
+static inline uint64_t prng_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Get next 64-bit random number
+ * @param prng generator
+ * @return random number
+ */
+static inline uint64_t prng_next(struct prng *prng)
+{
+    uint64_t *s = prng->s;
+    uint64_t result = prng_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = prng_rotl(s[3], 45);
+    return result;
+}
+
+/**
+ * Get a random 32-bit number, the high bits of the next number are the best ones
+ * @param prng generator
+ * @return random number
+ */
+static inline uint32_t prng_u32(struct prng *prng)
+{
+    return (uint32_t) (prng_next(prng) >> 32);
+}
+
+/**
+ * Get a random number from 0 to bound, bound excluded, without modulo bias
+ * The random number times bound is a 64-bit number whose high half is
+ * the result; low halves below 2^32 mod bound are drawn again (Lemire).
+ * @param prng generator
+ * @param bound number of possible results, not 0
+ * @return random number
+ */
+static inline uint32_t prng_below(struct prng *prng, uint32_t bound)
+{
+    uint64_t m = (uint64_t) prng_u32(prng) * bound;
+    if ((uint32_t) m < bound) {
+        uint32_t threshold = -bound % bound;
+        while ((uint32_t) m < threshold)
+            m = (uint64_t) prng_u32(prng) * bound;
+    }
+    return (uint32_t) (m >> 32);
+}
+
+/**
+ * Get a random number from 0 to 1, 1 excluded, with 53 random bits
+ * @param prng generator
+ * @return random number
+ */
+static inline double prng_fraction(struct prng *prng)
+{
+    return (double) (prng_next(prng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#endif //PRNG_H
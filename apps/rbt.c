@@ -4,390 +4,136 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-#define MAX_LINE_SIZE 1000   // maximum size of a line of input
-#define MAX_CMD_LENGTH 15   // maximum length of a command name
+#include "trees.h"
+#include "frozen_trees.h"
 
 /**
- * Extract command, key and data from command line.
- * @param cmd command to execute
- * @param key key to use
+ * Execute command with parameters.
+ * Available commands:
+ *   insert: insert a new node with key and data
+ *   binsert: queue key and data, queued keys are inserted at once
+ *            before the next command of another kind
+ *   find: find a node with key and, if found, return data
+ *   delete: remove the node with key
+ *   clear: remove every node from tree
+ *   load: add the "key data" lines, sorted by key, of file data to the tree
+ *   range: print "key:data" of the nodes with key from key to data, in order
+ *   rank: print the number of keys less than key
+ *   select: print "key:data" of the node at position key in order, from 1
+ *   show: print tree nodes in preorder
+ *   freeze: copy the tree in an Eytzinger layout (van Emde Boas with data "veb"),
+ *           next finds search the copy until a change to the tree thaws it
+ * @param arena arena to allocate nodes from
+ * @param frozen frozen copy of the tree
+ * @param batch keys queued by binsert
+ * @param root RBT root
+ * @param command command to execute
+ * @param key key to insert, search or delete, lowest key of range
  * @param data data to insert in key
+ * @return RBT root after operation
  */
-void scanLine(char *cmd, int *key, char *data) {
-    // scan line of text
-    char line[MAX_LINE_SIZE];
-    /*
-     * You can instruct the scanf to ignore the special characters
-     * by prefixing % by a space character.
-     */
-    scanf(" %[^\n]s", line);
-
-    char *tmp_cmd=strtok(line, " ");
-
-    /*
-     * strcpy doesn't allocate memory for you.
-     * you need to have the destination of strcpy be already
-     * allocated memory locations
-    */
-    strcpy(cmd, tmp_cmd);
-
-    char *param = strtok(NULL, "\n");
-
-    char tmp_data[MAX_LINE_SIZE];
-    strcpy(tmp_data, "");
-    // A null pointer is returned if there are no tokens left to retrieve.
-    if  (param != NULL) {
-        sscanf(param, "%d%s", key, tmp_data);
-        if ((strcmp(tmp_data, "") == 0)) {
-            strcpy(data, "");
-        } else {
-            strcpy(data, tmp_data);
-        }
-    } else {
-        strcpy(data, "");
-        *key = 0;
+struct rbt_node* doCommand(struct arena *arena, struct frozen *frozen, struct pairs *batch, struct rbt_node* root, char *command, int key, char *data)  {
+    if (batch->count > 0 && strcmp(command, "binsert") != 0)
+    {
+        frozen_free(frozen);
+        root = rbt_insert_batch(arena, root, batch);
+        pairs_clear(batch);
     }
-}
-
-/**
- * Enum to represent each
- * node color in a red-black tree
- */
-enum nodeColor {
-    BLACK,
-    RED
-};
 
-/**
- * Structure to represent each
- * node in a red-black tree
- */
-typedef struct rbt_node
-{
-    int key;
-    char *data;
-    enum nodeColor color;
-    struct rbt_node *parent;
-    struct rbt_node *left;
-    struct rbt_node *right;
-} rbt_node;
-
-
-// Use T_Nil as a sentinel to simplify code
-struct rbt_node *T_Nil;
-
-/**
- * Creates a new node, initializes and returns a pointer to it.
- * @param key node key
- * @param data node value
- * @return rbt node
- */
-struct rbt_node* rbt_create(int key, char *data)
-{
-    struct rbt_node *new_node;
-    new_node = (struct rbt_node *) malloc(sizeof(rbt_node));
-    if (new_node == NULL)
+    if (strcmp(command, "insert") == 0)
     {
-        fprintf (stderr, "create rbt node fail\n");
-        exit(1);
+        frozen_free(frozen);
+        root = rbt_insert(arena, root, key, data);
     }
-    new_node->key = key;
-    new_node->data = strdup(data);
-    new_node->color = RED;
-    new_node->left = NULL;
-    new_node->right = NULL;
-    new_node->parent = NULL;
-
-    return new_node;
-}
-
-/**
- * Left rotate RBT subtree rooted with x
- * @param root rbt_node RBT root
- * @param x rbt_node node to rotate
- * @return rotated RBT
- */
-struct rbt_node* rbt_left_rotate(rbt_node* root, rbt_node* x)
-{
-    // y stored pointer of right child of x
-    rbt_node *y = x->right;
-    // store y's left subtree's pointer as x's right child
-    x->right = y->left;
-    // update parent pointer of y's left
-    if (y->left != T_Nil)
-        y->left->parent = x;
-    // link x's parent to y
-    y->parent = x->parent;
-    // if x's parent is T_Nil make y as root of tree
-    if (x->parent == T_Nil)
-        root = y;
-    else if (x == x->parent->left)
-        x->parent->left = y;
-    else
-        x->parent->right = y;
-    // make x as left child of y
-    y->left = x;
-    // update parent pointer of x
-    x->parent = y;
-
-    // Return new root
-    return root;
-}
-
-/**
- * Right rotate RBT subtree rooted with y
- * @param root rbt_node RBT root
- * @param y rbt_node node to rotate
- * @return rotated RBT
- */
-struct rbt_node* rbt_right_rotate(rbt_node* root, rbt_node* y)
-{
-    // x stored pointer of left child of y
-    rbt_node *x = y->left;
-    // turn x's right subtree into y's left subtree
-    y->left = x->right;
-    // update parent pointer of x's right
-    if (x->right != T_Nil)
-        x->right->parent = y;
-    // update x's parent pointer
-    x->parent = y->parent;
-    // if y's parent is T_Nil make x as root of tree
-    if (y->parent == T_Nil)
-        root = x;
-    else if (y == y->parent->right)
-        y->parent->right = x;
-    else
-        y->parent->left  = x;
-    // make y as right child of x
-    x->right = y;
-    // update parent pointer of y
-    y->parent = x;
-
-    // Return new root
-    return root;
-}
-
-struct rbt_node* fixup(rbt_node* root, rbt_node* node)
-{
-    rbt_node* temp;
-    while (node->parent->color == RED)
+    else if (strcmp(command, "binsert") == 0)
     {
-        /* Case : A
-         * Parent of node is left child
-         * of Grand-parent of node
-         */
-        if (node->parent == node->parent->parent->left)
+        pairs_add(batch, key, data);
+        if (batch->count == BATCH_MAX_SIZE)
         {
-            temp = node->parent->parent->right;
-            /* Case : 1
-             *   The uncle of node is also red
-             *   Only Recoloring required
-             */
-            if (temp->color == RED)
-            {
-                node->parent->color = BLACK;
-                temp->color = BLACK;
-                node->parent->parent->color = RED;
-                node = node->parent->parent;
-            }
-            else {
-                /* Case : 2
-                 *   node is right child of its parent
-                 *   Left-rotation required
-                 */
-                if (node == node->parent->right)
-                {
-                    node = node->parent;
-                    root = rbt_left_rotate(root, node);
-                }
-                /* Case : 3
-                 *   node is left child of its parent
-                 *   Right-rotation required
-                 */
-                node->parent->color = BLACK;
-                node->parent->parent->color = RED;
-                root = rbt_right_rotate(root, node->parent->parent);
-            }
+            frozen_free(frozen);
+            root = rbt_insert_batch(arena, root, batch);
+            pairs_clear(batch);
         }
+    }
+    else if (strcmp(command, "find") == 0)
+    {
+        const char *found;
+        if (frozen_is_frozen(frozen))
+            found = frozen_find(frozen, key);
         else
+            found = rbt_find(root, key);
+        if (found != NULL)
         {
-            /* Case : B
-             *   Parent of node is right child
-             *   of Grand-parent of node
-             */
-            temp = node->parent->parent->left;
-            /* Case : 1
-             *   The uncle of node is also red
-             *   Only Recoloring required
-             */
-            if (temp->color == RED)
-            {
-                node->parent->color = BLACK;
-                temp->color = BLACK;
-                node->parent->parent->color = RED;
-                node = node->parent->parent;
-            }
-            else {
-                /* Case : 2
-                 *  node is left child of its parent
-                 *  Right-rotation required
-                 */
-                if (node == node->parent->left)
-                {
-                    node = node->parent;
-                    root = rbt_right_rotate(root, node);
-                }
-                /* Case : 3
-                 * node is right child of its parent
-                 * Left-rotation required
-                 */
-                node->parent->color = BLACK;
-                node->parent->parent->color = RED;
-                root = rbt_left_rotate(root, node->parent->parent);
-            }
+            output_string(found);
+            output_char('\n');
         }
     }
-    root->color = BLACK;
-    return root;
-}
-
-/**
- * Insert new node in a RBT
- * @param node RBT root
- * @param key key to insert
- * @param data value to insert
- */
-struct rbt_node* rbt_insert(struct rbt_node *node, int key, char* data)
-{
-    rbt_node* z = rbt_create(key, data);
-    rbt_node* y = T_Nil;
-    rbt_node* x = node;
-
-    // Find where to Insert new node Z into the RBT
-    while (x != T_Nil) {
-        y = x;
-        if (z->key < x->key)
-            x = x->left;
-        else
-            x = x->right;
-    }
-
-    z->parent = y;
-    if (y == T_Nil)
-        node = z;
-    else if (z->key < y->key)
-        y->left  = z;
-    else
-        y->right = z;
-
-    // Init z as a red leaf
-    z->left  = T_Nil;
-    z->right = T_Nil;
-    z->color = RED;
-
-    // Ensure the Red-Black property is maintained
-    node = fixup(node, z);
-    return node;
-}
-
-/**
- * Search a node with key and, if found, print its value
- * @param node BST to search for the key
- * @param key key to search
- */
-void rbt_find(struct rbt_node* node, int key) {
-    if (node->key == key) {
-        printf("%s", node->data);
-        printf("\n");
-
-    } else if (node->key < key) {
-        if (node->right != NULL)
-            return rbt_find(node->right, key);
-    } else {
-        if (node->left != NULL)
-            return rbt_find(node->left, key);
+    else if (strcmp(command, "delete") == 0)
+    {
+        frozen_free(frozen);
+        root = rbt_delete(arena, root, key);
     }
-}
-
-/**
- * Remove all nodes from RBT
- * Given a RBT, remove its nodes in postorder (left, right, root)
- * @param node
- */
-void rbt_clear(struct rbt_node* node) {
-    if (node == NULL || node == T_Nil)
-        return;
-
-    // first recur on left subtree
-    rbt_clear(node->left);
-
-    // then recur on right subtree
-    rbt_clear(node->right);
-
-    // now deal with the node
-    free(node);
-    node = NULL;
-}
-
-/**
- * Show current rbt with prefix expression (Polish notation)
- * Given a RBT, print its nodes in preorder (root, left, right)
- * @param node rbt to traverse
- */
-void rbt_show(struct rbt_node* node)
-{
-    if (node == T_Nil) {
-        printf("NULL ");
-        return;
+    else if (strcmp(command, "clear") == 0)
+    {
+        frozen_free(frozen);
+        rbt_clear(arena, root);
+        root = T_Nil;
     }
-
-    char color[6];
-    if (node->color == BLACK) {
-        strcpy(color, "black");
-    } else {
-        strcpy(color, "red");
+    else if (strcmp(command, "load") == 0)
+    {
+        frozen_free(frozen);
+        struct pairs pairs;
+        pairs_init(&pairs);
+        if (pairs_read(&pairs, data) && pairs_sorted(&pairs))
+            root = rbt_load(arena, root, &pairs);
+        else
+        {
+            output_string("Error! cannot load file");
+            output_char('\n');
+        }
+        pairs_free(&pairs);
     }
-    /* first print data of node */
-    printf("%d:%s:%s ", node->key, node->data, color);
-
-    /* then recur on left subtree */
-    rbt_show(node->left);
-
-    /* now recur on right subtree */
-    rbt_show(node->right);
-}
-
-/**
- * Execute command with parameters.
- * Available commands:
- *   insert: insert a new node with key and data
- *   find: find a node with key and, if found, return data
- *   clear: remove every node from tree
- *   show: print tree nodes in preorder
- * @param command command to execute
- * @param key key to insert or search
- * @param data data to insert in key
- * @return RBT root after operation
- */
-struct rbt_node* doCommand(struct rbt_node* root, char *command, int key, char *data)  {
-    if (strcmp(command, "insert") == 0)
+    else if (strcmp(command, "range") == 0)
     {
-        root = rbt_insert(root, key, data);
+        // data is the highest key
+        int high = atoi(data);
+        struct rbt_iterator it;
+        struct rbt_node *node;
+        rbt_iter_seek(&it, root, key);
+        while ((node = rbt_iter_next(&it)) != NULL && node->key <= high)
+        {
+            output_int(node->key);
+            output_char(':');
+            output_string(payload_get(&node->data));
+            output_char(' ');
+        }
+        output_char('\n');
     }
-    else if (strcmp(command, "find") == 0)
+    else if (strcmp(command, "rank") == 0)
     {
-        rbt_find(root, key);
+        output_int(rbt_rank(root, key));
+        output_char('\n');
     }
-    else if (strcmp(command, "clear") == 0)
+    else if (strcmp(command, "select") == 0)
     {
-        rbt_clear(root);
-        root = T_Nil;
+        // key is the position in order, from 1
+        struct rbt_node *node = rbt_select(root, key);
+        if (node != NULL)
+        {
+            output_int(node->key);
+            output_char(':');
+            output_string(payload_get(&node->data));
+        }
+        output_char('\n');
     }
     else if (strcmp(command, "show") == 0)
     {
         rbt_show(root);
-        printf("\n");
+        output_char('\n');
+    }
+    else if (strcmp(command, "freeze") == 0)
+    {
+        rbt_freeze(frozen, root, (strcmp(data, "veb") == 0) ? VAN_EMDE_BOAS : EYTZINGER);
     }
     else if (strcmp(command, "exit") == 0)
     {
@@ -396,27 +142,46 @@ struct rbt_node* doCommand(struct rbt_node* root, char *command, int key, char *
         /* more else if clauses */
     else /* default: */
     {
-        printf("Error! operator is not correct");
+        output_string("Error! operator is not correct");
         exit(0);
     }
+    output_end_command();
     return root;
 }
 
-int main ()
+/**
+ * Read commands from stdin and execute them.
+ * Option -b: batch output, flushed only when the buffer fills or at exit.
+ */
+int main (int argc, char *argv[])
 {
-    // Initialize T_Nil sentinel
-    T_Nil = (struct rbt_node *) malloc(sizeof(rbt_node));
+    output_init((argc > 1 && strcmp(argv[1], "-b") == 0) ? FLUSH_FULL : FLUSH_COMMAND);
     struct rbt_node* root = T_Nil;
+    // All nodes live in one arena, released by clear
+    struct arena arena;
+    arena_init(&arena, ARENA_SLAB_SIZE);
+    // Frozen copy of the tree for finds, empty until a freeze command
+    struct frozen frozen;
+    frozen_init(&frozen);
+    // Keys of binsert commands, waiting to be inserted
+    struct pairs batch;
+    pairs_init(&batch);
+    // Commands are parsed in place from a large buffer of stdin
+    struct reader reader;
+    reader_init(&reader, 0);
     int key = 0;
-    char command[MAX_CMD_LENGTH];
-    char data[MAX_CMD_LENGTH];
+    char *command;
+    char *data;
 
-    while ((strcmp(command, "exit") != 0))
+    // read command, key and data from stdin
+    while (reader_next(&reader, &command, &key, &data))
     {
-        scanLine(command, &key, data); // read command, key and data from stdin
         // execute command
-        root = doCommand(root, (char *) &command, key, (char *) &data);
+        root = doCommand(&arena, &frozen, &batch, root, command, key, data);
     }
-    free(T_Nil);
+    reader_free(&reader);
+    pairs_free(&batch);
+    frozen_free(&frozen);
+    arena_free(&arena);
     return 0;
 }
@@ -0,0 +1,295 @@
+//
+// Red-Black Tree with the color packed in the parent pointer
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trees.h"
+
+// Use TP_Nil as a sentinel to simplify code
+// the sentinel is zero initialized, that is BLACK with NULL parent
+static struct rbtp_node rbtp_sentinel;
+struct rbtp_node *TP_Nil = &rbtp_sentinel;
+
+/**
+ * Creates a new node, initializes and returns a pointer to it.
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param key node key
+ * @param data node value
+ * @return rbtp node
+ */
+struct rbtp_node* rbtp_create(struct arena *arena, int key, char *data)
+{
+    struct rbtp_node *new_node;
+    if (arena != NULL)
+        new_node = (struct rbtp_node *) arena_alloc(arena, sizeof(rbtp_node));
+    else
+        new_node = (struct rbtp_node *) malloc(sizeof(rbtp_node));
+    if (new_node == NULL)
+    {
+        fprintf (stderr, "create rbtp node fail\n");
+        exit(1);
+    }
+    new_node->key = key;
+    payload_set(&new_node->data, arena, data);
+    new_node->parent_color = (uintptr_t) NULL | RED;
+    new_node->left = NULL;
+    new_node->right = NULL;
+
+    return new_node;
+}
+
+/**
+ * Left rotate RBT subtree rooted with x
+ * @param root rbtp_node RBT root
+ * @param x rbtp_node node to rotate
+ * @return rotated RBT
+ */
+struct rbtp_node* rbtp_left_rotate(rbtp_node* root, rbtp_node* x)
+{
+    // y stored pointer of right child of x
+    rbtp_node *y = x->right;
+    rbtp_node *parent = rbtp_parent(x);
+    // store y's left subtree's pointer as x's right child
+    x->right = y->left;
+    // update parent pointer of y's left
+    if (y->left != TP_Nil)
+        rbtp_set_parent(y->left, x);
+    // link x's parent to y
+    rbtp_set_parent(y, parent);
+    // if x's parent is TP_Nil make y as root of tree
+    if (parent == TP_Nil)
+        root = y;
+    else if (x == parent->left)
+        parent->left = y;
+    else
+        parent->right = y;
+    // make x as left child of y
+    y->left = x;
+    // update parent pointer of x
+    rbtp_set_parent(x, y);
+
+    // Return new root
+    return root;
+}
+
+/**
+ * Right rotate RBT subtree rooted with y
+ * @param root rbtp_node RBT root
+ * @param y rbtp_node node to rotate
+ * @return rotated RBT
+ */
+struct rbtp_node* rbtp_right_rotate(rbtp_node* root, rbtp_node* y)
+{
+    // x stored pointer of left child of y
+    rbtp_node *x = y->left;
+    rbtp_node *parent = rbtp_parent(y);
+    // turn x's right subtree into y's left subtree
+    y->left = x->right;
+    // update parent pointer of x's right
+    if (x->right != TP_Nil)
+        rbtp_set_parent(x->right, y);
+    // update x's parent pointer
+    rbtp_set_parent(x, parent);
+    // if y's parent is TP_Nil make x as root of tree
+    if (parent == TP_Nil)
+        root = x;
+    else if (y == parent->right)
+        parent->right = x;
+    else
+        parent->left  = x;
+    // make y as right child of x
+    x->right = y;
+    // update parent pointer of y
+    rbtp_set_parent(y, x);
+
+    // Return new root
+    return root;
+}
+
+/**
+ * Resort the Red-Black tree properties
+ * @param root RBT root
+ * @param node node to fixup
+ * @return RBT root node
+ */
+static struct rbtp_node* rbtp_fixup(rbtp_node* root, rbtp_node* node)
+{
+    rbtp_node* temp;
+    rbtp_node* parent;
+    rbtp_node* grandparent;
+    while (rbtp_color(parent = rbtp_parent(node)) == RED)
+    {
+        grandparent = rbtp_parent(parent);
+        /* Case : A
+         * Parent of node is left child
+         * of Grand-parent of node
+         */
+        if (parent == grandparent->left)
+        {
+            temp = grandparent->right;
+            /* Case : 1
+             *   The uncle of node is also red
+             *   Only Recoloring required
+             */
+            if (rbtp_color(temp) == RED)
+            {
+                rbtp_set_color(parent, BLACK);
+                rbtp_set_color(temp, BLACK);
+                rbtp_set_color(grandparent, RED);
+                node = grandparent;
+            }
+            else {
+                /* Case : 2
+                 *   node is right child of its parent
+                 *   Left-rotation required
+                 */
+                if (node == parent->right)
+                {
+                    node = parent;
+                    root = rbtp_left_rotate(root, node);
+                    parent = rbtp_parent(node);
+                }
+                /* Case : 3
+                 *   node is left child of its parent
+                 *   Right-rotation required
+                 */
+                rbtp_set_color(parent, BLACK);
+                rbtp_set_color(grandparent, RED);
+                root = rbtp_right_rotate(root, grandparent);
+            }
+        }
+        else
+        {
+            /* Case : B
+             *   Parent of node is right child
+             *   of Grand-parent of node
+             */
+            temp = grandparent->left;
+            /* Case : 1
+             *   The uncle of node is also red
+             *   Only Recoloring required
+             */
+            if (rbtp_color(temp) == RED)
+            {
+                rbtp_set_color(parent, BLACK);
+                rbtp_set_color(temp, BLACK);
+                rbtp_set_color(grandparent, RED);
+                node = grandparent;
+            }
+            else {
+                /* Case : 2
+                 *  node is left child of its parent
+                 *  Right-rotation required
+                 */
+                if (node == parent->left)
+                {
+                    node = parent;
+                    root = rbtp_right_rotate(root, node);
+                    parent = rbtp_parent(node);
+                }
+                /* Case : 3
+                 * node is right child of its parent
+                 * Left-rotation required
+                 */
+                rbtp_set_color(parent, BLACK);
+                rbtp_set_color(grandparent, RED);
+                root = rbtp_left_rotate(root, grandparent);
+            }
+        }
+    }
+    rbtp_set_color(root, BLACK);
+    return root;
+}
+
+/**
+ * Insert new node in a RBT
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param node RBT root
+ * @param key key to insert
+ * @param data value to insert
+ */
+struct rbtp_node* rbtp_insert(struct arena *arena, struct rbtp_node *node, int key, char* data)
+{
+    rbtp_node* z = rbtp_create(arena, key, data);
+    rbtp_node* y = TP_Nil;
+    rbtp_node* x = node;
+
+    // Find where to Insert new node Z into the RBT
+    while (x != TP_Nil) {
+        y = x;
+        if (z->key < x->key)
+            x = x->left;
+        else
+            x = x->right;
+    }
+
+    // Init z as a red leaf
+    z->parent_color = (uintptr_t) y | RED;
+    if (y == TP_Nil)
+        node = z;
+    else if (z->key < y->key)
+        y->left  = z;
+    else
+        y->right = z;
+    z->left  = TP_Nil;
+    z->right = TP_Nil;
+
+    // Ensure the Red-Black property is maintained
+    node = rbtp_fixup(node, z);
+    return node;
+}
+
+/**
+ * Search a node with key and, if found, return its value
+ * @param node RBT to search for the key
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* rbtp_find(struct rbtp_node* node, int key) {
+    while (node != TP_Nil) {
+        if (node->key == key)
+            return payload_get(&node->data);
+        if (node->key < key)
+            node = node->right;
+        else
+            node = node->left;
+    }
+    return NULL;
+}
+
+/**
+ * Free all nodes allocated with malloc
+ * Same rotations of rbt_free_nodes, parent pointers are not needed.
+ * @param node
+ */
+void rbtp_free_nodes(struct rbtp_node* node) {
+    while (node != NULL && node != TP_Nil) {
+        if (node->left != TP_Nil) {
+            // right rotation: left child becomes the subtree root
+            struct rbtp_node *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            // no left subtree: deal with the node, then go right
+            struct rbtp_node *right = node->right;
+            payload_free(&node->data);
+            free(node);
+            node = right;
+        }
+    }
+}
+
+/**
+ * Remove all nodes from RBT
+ * Nodes taken from an arena are released at once in O(1)
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node RBT root
+ */
+void rbtp_clear(struct arena *arena, struct rbtp_node* node) {
+    if (arena != NULL)
+        arena_clear(arena);
+    else
+        rbtp_free_nodes(node);
+}
@@ -0,0 +1,1156 @@
+//
+// Red-Black Tree
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "trees.h"
+
+// Use T_Nil as a sentinel to simplify code
+// the sentinel is zero initialized, that is BLACK
+static struct rbt_node rbt_sentinel;
+struct rbt_node *T_Nil = &rbt_sentinel;
+
+/**
+ * Update the subtree size of a node from its children, if sizes are kept
+ * @param node rbt_node, not T_Nil
+ */
+static void update_size(struct rbt_node* node)
+{
+#ifdef SUBTREE_SIZE
+    node->size = node->left->size + node->right->size + 1;
+#else
+    (void) node;
+#endif
+}
+
+/**
+ * Creates a new node, initializes and returns a pointer to it.
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param key node key
+ * @param data node value
+ * @return rbt node
+ */
+struct rbt_node* rbt_create(struct arena *arena, int key, char *data)
+{
+    struct rbt_node *new_node;
+    if (arena != NULL)
+        new_node = (struct rbt_node *) arena_alloc(arena, sizeof(rbt_node));
+    else
+        new_node = (struct rbt_node *) malloc(sizeof(rbt_node));
+    if (new_node == NULL)
+    {
+        fprintf (stderr, "create rbt node fail\n");
+        exit(1);
+    }
+    new_node->key = key;
+    payload_set(&new_node->data, arena, data);
+    new_node->color = RED;
+    new_node->left = NULL;
+    new_node->right = NULL;
+    new_node->parent = NULL;
+#ifdef SUBTREE_SIZE
+    new_node->size = 1;
+#endif
+
+    return new_node;
+}
+
+/**
+ * Left rotate RBT subtree rooted with x
+ * @param root rbt_node RBT root
+ * @param x rbt_node node to rotate
+ * @return rotated RBT
+ */
+struct rbt_node* rbt_left_rotate(rbt_node* root, rbt_node* x)
+{
+    // y stored pointer of right child of x
+    rbt_node *y = x->right;
+    // store y's left subtree's pointer as x's right child
+    x->right = y->left;
+    // update parent pointer of y's left
+    if (y->left != T_Nil)
+        y->left->parent = x;
+    // link x's parent to y
+    y->parent = x->parent;
+    // if x's parent is T_Nil make y as root of tree
+    if (x->parent == T_Nil)
+        root = y;
+    else if (x == x->parent->left)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+    // make x as left child of y
+    y->left = x;
+    // update parent pointer of x
+    x->parent = y;
+#ifdef SUBTREE_SIZE
+    // y roots the nodes x rooted
+    y->size = x->size;
+#endif
+    update_size(x);
+
+    // Return new root
+    return root;
+}
+
+/**
+ * Right rotate RBT subtree rooted with y
+ * @param root rbt_node RBT root
+ * @param y rbt_node node to rotate
+ * @return rotated RBT
+ */
+struct rbt_node* rbt_right_rotate(rbt_node* root, rbt_node* y)
+{
+    // x stored pointer of left child of y
+    rbt_node *x = y->left;
+    // turn x's right subtree into y's left subtree
+    y->left = x->right;
+    // update parent pointer of x's right
+    if (x->right != T_Nil)
+        x->right->parent = y;
+    // update x's parent pointer
+    x->parent = y->parent;
+    // if y's parent is T_Nil make x as root of tree
+    if (y->parent == T_Nil)
+        root = x;
+    else if (y == y->parent->right)
+        y->parent->right = x;
+    else
+        y->parent->left  = x;
+    // make y as right child of x
+    x->right = y;
+    // update parent pointer of y
+    y->parent = x;
+#ifdef SUBTREE_SIZE
+    // x roots the nodes y rooted
+    x->size = y->size;
+#endif
+    update_size(y);
+
+    // Return new root
+    return root;
+}
+
+/**
+ * Resort the Red-Black tree properties, but the color of the root
+ * Red nodes move up until node has a black parent, the root may end up red.
+ * @param root RBT root
+ * @param node red node to fixup
+ * @return RBT root node
+ */
+static struct rbt_node* fixup_red(rbt_node* root, rbt_node* node)
+{
+    rbt_node* temp;
+    while (node->parent->color == RED)
+    {
+        /* Case : A
+         * Parent of node is left child
+         * of Grand-parent of node
+         */
+        if (node->parent == node->parent->parent->left)
+        {
+            temp = node->parent->parent->right;
+            /* Case : 1
+             *   The uncle of node is also red
+             *   Only Recoloring required
+             */
+            if (temp->color == RED)
+            {
+                node->parent->color = BLACK;
+                temp->color = BLACK;
+                node->parent->parent->color = RED;
+                node = node->parent->parent;
+            }
+            else {
+                /* Case : 2
+                 *   node is right child of its parent
+                 *   Left-rotation required
+                 */
+                if (node == node->parent->right)
+                {
+                    node = node->parent;
+                    root = rbt_left_rotate(root, node);
+                }
+                /* Case : 3
+                 *   node is left child of its parent
+                 *   Right-rotation required
+                 */
+                node->parent->color = BLACK;
+                node->parent->parent->color = RED;
+                root = rbt_right_rotate(root, node->parent->parent);
+            }
+        }
+        else
+        {
+            /* Case : B
+             *   Parent of node is right child
+             *   of Grand-parent of node
+             */
+            temp = node->parent->parent->left;
+            /* Case : 1
+             *   The uncle of node is also red
+             *   Only Recoloring required
+             */
+            if (temp->color == RED)
+            {
+                node->parent->color = BLACK;
+                temp->color = BLACK;
+                node->parent->parent->color = RED;
+                node = node->parent->parent;
+            }
+            else {
+                /* Case : 2
+                 *  node is left child of its parent
+                 *  Right-rotation required
+                 */
+                if (node == node->parent->left)
+                {
+                    node = node->parent;
+                    root = rbt_right_rotate(root, node);
+                }
+                /* Case : 3
+                 * node is right child of its parent
+                 * Left-rotation required
+                 */
+                node->parent->color = BLACK;
+                node->parent->parent->color = RED;
+                root = rbt_left_rotate(root, node->parent->parent);
+            }
+        }
+    }
+    return root;
+}
+
+/**
+ * Resort the Red-Black tree properties
+ * @param root RBT root
+ * @param node node to fixup
+ * @return RBT root node
+ */
+static struct rbt_node* fixup(rbt_node* root, rbt_node* node)
+{
+    root = fixup_red(root, node);
+    root->color = BLACK;
+    return root;
+}
+
+/**
+ * Insert new node in a RBT
+ * @param arena arena to allocate the node from, NULL to use malloc
+ * @param node RBT root
+ * @param key key to insert
+ * @param data value to insert
+ */
+struct rbt_node* rbt_insert(struct arena *arena, struct rbt_node *node, int key, char* data)
+{
+    rbt_node* z = rbt_create(arena, key, data);
+    rbt_node* y = T_Nil;
+    rbt_node* x = node;
+
+    // Find where to Insert new node Z into the RBT
+    while (x != T_Nil) {
+        y = x;
+#ifdef SUBTREE_SIZE
+        // z goes in the subtree of x
+        x->size++;
+#endif
+        if (z->key < x->key)
+            x = x->left;
+        else
+            x = x->right;
+    }
+
+    z->parent = y;
+    if (y == T_Nil)
+        node = z;
+    else if (z->key < y->key)
+        y->left  = z;
+    else
+        y->right = z;
+
+    // Init z as a red leaf
+    z->left  = T_Nil;
+    z->right = T_Nil;
+    z->color = RED;
+
+    // Ensure the Red-Black property is maintained
+    node = fixup(node, z);
+    return node;
+}
+
+/**
+ * Search a node with key and, if found, return its value
+ * @param node RBT to search for the key
+ * @param key key to search
+ * @return node data if key exist, NULL otherwise
+ */
+const char* rbt_find(struct rbt_node* node, int key) {
+    while (node != T_Nil) {
+        if (node->key == key)
+            return payload_get(&node->data);
+        if (node->key < key)
+            node = node->right;
+        else
+            node = node->left;
+    }
+    return NULL;
+}
+
+/**
+ * Free a single RBT node and its data
+ * @param arena arena the node comes from, NULL if allocated with malloc
+ * @param node node to free
+ */
+static void rbt_destroy(struct arena *arena, struct rbt_node *node)
+{
+    if (arena != NULL) {
+        arena_release(arena, node, sizeof(rbt_node));
+    } else {
+        payload_free(&node->data);
+        free(node);
+    }
+}
+
+/**
+ * Replace subtree rooted at u with subtree rooted at v
+ * T_Nil is shared by all RBTs and never written: when v is T_Nil,
+ * its parent is not set, callers keep it themselves.
+ * @param root RBT root
+ * @param u rbt_node subtree to replace
+ * @param v rbt_node new subtree
+ * @return RBT root
+ */
+static struct rbt_node* rbt_transplant(rbt_node* root, rbt_node* u, rbt_node* v)
+{
+    if (u->parent == T_Nil)
+        root = v;
+    else if (u == u->parent->left)
+        u->parent->left = v;
+    else
+        u->parent->right = v;
+    if (v != T_Nil)
+        v->parent = u->parent;
+    return root;
+}
+
+/**
+ * Resort the Red-Black tree properties after a delete
+ * node carries an extra black, moved up until it reaches a red node or the root
+ * node may be T_Nil, whose parent is not kept: parent is passed along.
+ * @param root RBT root
+ * @param node node to fixup
+ * @param parent parent of node
+ * @return RBT root node
+ */
+static struct rbt_node* delete_fixup(rbt_node* root, rbt_node* node, rbt_node* parent)
+{
+    rbt_node* sibling;
+    while (node != root && node->color == BLACK)
+    {
+        /* Case : A
+         * node is left child of its parent
+         */
+        if (node == parent->left)
+        {
+            sibling = parent->right;
+            /* Case : 1
+             *   The sibling of node is red
+             *   Recoloring and left-rotation of parent
+             */
+            if (sibling->color == RED)
+            {
+                sibling->color = BLACK;
+                parent->color = RED;
+                root = rbt_left_rotate(root, parent);
+                sibling = parent->right;
+            }
+            /* Case : 2
+             *   Both children of sibling are black
+             *   Only Recoloring required, move up the extra black
+             */
+            if (sibling->left->color == BLACK && sibling->right->color == BLACK)
+            {
+                sibling->color = RED;
+                node = parent;
+                parent = node->parent;
+            }
+            else {
+                /* Case : 3
+                 *   Right child of sibling is black
+                 *   Right-rotation of sibling required
+                 */
+                if (sibling->right->color == BLACK)
+                {
+                    sibling->left->color = BLACK;
+                    sibling->color = RED;
+                    root = rbt_right_rotate(root, sibling);
+                    sibling = parent->right;
+                }
+                /* Case : 4
+                 *   Right child of sibling is red
+                 *   Left-rotation of parent removes the extra black
+                 */
+                sibling->color = parent->color;
+                parent->color = BLACK;
+                sibling->right->color = BLACK;
+                root = rbt_left_rotate(root, parent);
+                node = root;
+            }
+        }
+        else
+        {
+            /* Case : B
+             * node is right child of its parent
+             */
+            sibling = parent->left;
+            /* Case : 1
+             *   The sibling of node is red
+             *   Recoloring and right-rotation of parent
+             */
+            if (sibling->color == RED)
+            {
+                sibling->color = BLACK;
+                parent->color = RED;
+                root = rbt_right_rotate(root, parent);
+                sibling = parent->left;
+            }
+            /* Case : 2
+             *   Both children of sibling are black
+             *   Only Recoloring required, move up the extra black
+             */
+            if (sibling->right->color == BLACK && sibling->left->color == BLACK)
+            {
+                sibling->color = RED;
+                node = parent;
+                parent = node->parent;
+            }
+            else {
+                /* Case : 3
+                 *   Left child of sibling is black
+                 *   Left-rotation of sibling required
+                 */
+                if (sibling->left->color == BLACK)
+                {
+                    sibling->right->color = BLACK;
+                    sibling->color = RED;
+                    root = rbt_left_rotate(root, sibling);
+                    sibling = parent->left;
+                }
+                /* Case : 4
+                 *   Left child of sibling is red
+                 *   Right-rotation of parent removes the extra black
+                 */
+                sibling->color = parent->color;
+                parent->color = BLACK;
+                sibling->left->color = BLACK;
+                root = rbt_right_rotate(root, parent);
+                node = root;
+            }
+        }
+    }
+    if (node != T_Nil)
+        node->color = BLACK;
+    return root;
+}
+
+/**
+ * Unlink a node from a RBT, the node is not freed
+ * @param node RBT root
+ * @param z node to unlink
+ * @return RBT without z
+ */
+static struct rbt_node* rbt_remove(struct rbt_node *node, struct rbt_node *z)
+{
+    // y is the node removed from the tree, x the node moving into its place
+    // x may be T_Nil, whose parent is not set: x_parent keeps it
+    rbt_node* y = z;
+    rbt_node* x;
+    rbt_node* x_parent;
+    enum nodeColor y_color = y->color;
+    if (z->left == T_Nil) {
+        x = z->right;
+        x_parent = z->parent;
+        node = rbt_transplant(node, z, z->right);
+    } else if (z->right == T_Nil) {
+        x = z->left;
+        x_parent = z->parent;
+        node = rbt_transplant(node, z, z->left);
+    } else {
+        // z has two children: its successor y takes its place
+        y = z->right;
+        while (y->left != T_Nil)
+            y = y->left;
+        y_color = y->color;
+        x = y->right;
+        if (y->parent == z) {
+            x_parent = y;
+        } else {
+            x_parent = y->parent;
+            node = rbt_transplant(node, y, y->right);
+            y->right = z->right;
+            y->right->parent = y;
+        }
+        node = rbt_transplant(node, z, y);
+        y->left = z->left;
+        y->left->parent = y;
+        y->color = z->color;
+    }
+
+    // sizes change from the parent of x up to the root
+    for (struct rbt_node *p = x_parent; p != T_Nil; p = p->parent)
+        update_size(p);
+
+    // Removing a black node breaks the Red-Black properties
+    if (y_color == BLACK)
+        node = delete_fixup(node, x, x_parent);
+    return node;
+}
+
+/**
+ * Delete the node with key from a RBT
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node RBT root
+ * @param key key to delete
+ * @return RBT without the key
+ */
+struct rbt_node* rbt_delete(struct arena *arena, struct rbt_node *node, int key)
+{
+    rbt_node* z = node;
+
+    // Find the node to delete
+    while (z != T_Nil && z->key != key) {
+        if (key < z->key)
+            z = z->left;
+        else
+            z = z->right;
+    }
+    if (z == T_Nil)
+        return node;
+
+    node = rbt_remove(node, z);
+    rbt_destroy(arena, z);
+    return node;
+}
+
+/**
+ * Free all nodes allocated with malloc
+ * Given a RBT, rotate the left child up until the node has none,
+ * then free the node and go on with its right child:
+ * no recursion and no extra memory, whatever the tree shape.
+ * @param node
+ */
+void rbt_free_nodes(struct rbt_node* node) {
+    while (node != NULL && node != T_Nil) {
+        if (node->left != T_Nil) {
+            // right rotation: left child becomes the subtree root
+            struct rbt_node *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            // no left subtree: deal with the node, then go right
+            struct rbt_node *right = node->right;
+            payload_free(&node->data);
+            free(node);
+            node = right;
+        }
+    }
+}
+
+/**
+ * Remove all nodes from RBT
+ * Nodes taken from an arena are released at once in O(1)
+ * @param arena arena the nodes come from, NULL if allocated with malloc
+ * @param node RBT root
+ */
+void rbt_clear(struct arena *arena, struct rbt_node* node) {
+    if (arena != NULL)
+        arena_clear(arena);
+    else
+        rbt_free_nodes(node);
+}
+
+/**
+ * Print key and data of a node of a RBT
+ * @param node node to print
+ */
+static void rbt_show_node(struct rbt_node* node)
+{
+    output_int(node->key);
+    output_char(':');
+    output_string(payload_get(&node->data));
+    output_char(':');
+    output_string(node->color == BLACK ? "black" : "red");
+    output_char(' ');
+}
+
+/**
+ * Show current rbt with prefix expression (Polish notation)
+ * Given a RBT, print its nodes in preorder (root, left, right).
+ * Morris traversal: the rightmost node of each left subtree is temporarily
+ * threaded to its successor, so no recursion nor stack is needed.
+ * A thread found again marks the end of a left subtree, whose last node
+ * has an empty right child.
+ * @param node rbt to traverse
+ */
+void rbt_show(struct rbt_node* node)
+{
+    struct rbt_node *pred;
+    while (node != T_Nil) {
+        if (node->left == T_Nil) {
+            /* print data of node and its empty left subtree, then go right */
+            rbt_show_node(node);
+            output_string("NULL ");
+            node = node->right;
+            continue;
+        }
+
+        // find the rightmost node of left subtree
+        pred = node->left;
+        while (pred->right != T_Nil && pred->right != node)
+            pred = pred->right;
+
+        if (pred->right == T_Nil) {
+            /* first visit: print data of node, thread it and go left */
+            rbt_show_node(node);
+            pred->right = node;
+            node = node->left;
+        } else {
+            /* left subtree done: remove the thread, print its empty right child and go right */
+            pred->right = T_Nil;
+            output_string("NULL ");
+            node = node->right;
+        }
+    }
+    /* empty right child of the last node (or empty tree) */
+    output_string("NULL ");
+}
+
+/**
+ * Collect the nodes of a RBT in order, following parent pointers
+ * @param node RBT root
+ * @param nodes nodes in order, NULL to count only
+ * @return number of nodes
+ */
+int rbt_in_order(struct rbt_node* node, struct rbt_node **nodes)
+{
+    int n = 0;
+
+    if (node == T_Nil)
+        return 0;
+    while (node->left != T_Nil)
+        node = node->left;
+    while (node != T_Nil) {
+        if (nodes != NULL)
+            nodes[n] = node;
+        n++;
+        if (node->right != T_Nil) {
+            // successor is the leftmost node of right subtree
+            node = node->right;
+            while (node->left != T_Nil)
+                node = node->left;
+        } else {
+            // successor is the first ancestor reached from its left subtree
+            struct rbt_node *child;
+            do {
+                child = node;
+                node = node->parent;
+            } while (node != T_Nil && child == node->right);
+        }
+    }
+    return n;
+}
+
+/**
+ * Link nodes in order into a complete RBT in O(n)
+ * Node i in order takes slot i in order of an implicit complete tree,
+ * the children of slot k are slots 2k and 2k + 1. Every node is black but
+ * the ones of the last level when it is not full: they are red, so every
+ * path has the same number of black nodes.
+ * @param nodes nodes sorted by key
+ * @param n number of nodes
+ * @return RBT root
+ */
+struct rbt_node* rbt_build(struct rbt_node **nodes, int n)
+{
+    if (n == 0)
+        return T_Nil;
+    struct rbt_node **slots = (struct rbt_node **) malloc((n + 1) * sizeof(struct rbt_node *));
+    if (slots == NULL)
+    {
+        fprintf (stderr, "create rbt slots fail\n");
+        exit(1);
+    }
+    int first = implicit_first(n);
+    int k = first;
+    for (int i = 0; i < n; i++) {
+        slots[k] = nodes[i];
+        k = implicit_next(k, n);
+    }
+    // first is the leftmost slot of the last level, the level is full if n = 2^h - 1
+    int full = ((n + 1) & n) == 0;
+    for (k = 1; k <= n; k++) {
+        slots[k]->parent = (k == 1) ? T_Nil : slots[k / 2];
+        slots[k]->left = (2 * k <= n) ? slots[2 * k] : T_Nil;
+        slots[k]->right = (2 * k + 1 <= n) ? slots[2 * k + 1] : T_Nil;
+        slots[k]->color = (!full && k >= first) ? RED : BLACK;
+    }
+    // children come after their parent
+    for (k = n; k >= 1; k--)
+        update_size(slots[k]);
+    struct rbt_node *root = slots[1];
+    free(slots);
+    return root;
+}
+
+/**
+ * Add sorted pairs to a RBT in O(n)
+ * Nodes of the RBT and new nodes are merged in order, then linked again
+ * into a complete RBT. Equal keys are kept, new ones after.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node RBT root
+ * @param pairs pairs sorted by key
+ * @return RBT with new nodes
+ */
+struct rbt_node* rbt_load(struct arena *arena, struct rbt_node *node, const struct pairs *pairs)
+{
+    int old = rbt_in_order(node, NULL);
+    struct rbt_node **nodes = (struct rbt_node **) malloc((old + pairs->count + 1) * sizeof(struct rbt_node *));
+    if (nodes == NULL)
+    {
+        fprintf (stderr, "create rbt slots fail\n");
+        exit(1);
+    }
+    // old nodes at the end, merged from the start: writes never reach unread nodes
+    rbt_in_order(node, nodes + pairs->count);
+    int a = pairs->count;
+    int end = pairs->count + old;
+    int b = 0;
+    int n = 0;
+    while (a < end || b < pairs->count) {
+        if (b == pairs->count || (a < end && nodes[a]->key <= pairs->keys[b])) {
+            nodes[n++] = nodes[a++];
+        } else {
+            nodes[n++] = rbt_create(arena, pairs->keys[b], pairs_data(pairs, b));
+            b++;
+        }
+    }
+    node = rbt_build(nodes, n);
+    free(nodes);
+    return node;
+}
+
+/**
+ * Move a cursor to the first node of a RBT whose key is not less than key
+ * Only the nodes on the path from the root are visited.
+ * @param it cursor
+ * @param root RBT root
+ * @param key lowest key to visit
+ */
+void rbt_iter_seek(struct rbt_iterator *it, struct rbt_node *root, int key)
+{
+    it->node = T_Nil;
+    while (root != T_Nil) {
+        if (root->key >= key) {
+            it->node = root;
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+}
+
+/**
+ * Get the node of a cursor and move it to the next node in order
+ * @param it cursor
+ * @return current node, NULL after the last node
+ */
+struct rbt_node* rbt_iter_next(struct rbt_iterator *it)
+{
+    struct rbt_node *node = it->node;
+    if (node == T_Nil)
+        return NULL;
+
+    struct rbt_node *next = node->right;
+    if (next != T_Nil) {
+        // leftmost node of right subtree
+        while (next->left != T_Nil)
+            next = next->left;
+    } else {
+        // up while coming from a right child
+        struct rbt_node *child = node;
+        next = node->parent;
+        while (next != T_Nil && child == next->right) {
+            child = next;
+            next = next->parent;
+        }
+    }
+    it->node = next;
+    return node;
+}
+
+/**
+ * Get the rank of a key in a RBT: the number of keys less than key
+ * With subtree sizes it is O(log n), else the keys are counted in order.
+ * @param node RBT root
+ * @param key key to rank, it may be missing
+ * @return number of keys less than key
+ */
+int rbt_rank(struct rbt_node* node, int key)
+{
+    int rank = 0;
+#ifdef SUBTREE_SIZE
+    while (node != T_Nil) {
+        if (node->key < key) {
+            // node and its left subtree are less than key
+            rank += node->left->size + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+#else
+    struct rbt_iterator it;
+    rbt_iter_seek(&it, node, INT_MIN);
+    while ((node = rbt_iter_next(&it)) != NULL && node->key < key)
+        rank++;
+#endif
+    return rank;
+}
+
+/**
+ * Select the k-th smallest key of a RBT, equal keys count once each
+ * With subtree sizes it is O(log n), else the nodes are visited in order.
+ * @param node RBT root
+ * @param k position in order, from 1
+ * @return k-th node, NULL if k is not between 1 and the number of nodes
+ */
+struct rbt_node* rbt_select(struct rbt_node* node, int k)
+{
+    if (k < 1)
+        return NULL;
+#ifdef SUBTREE_SIZE
+    while (node != T_Nil) {
+        int left = node->left->size;
+        if (k <= left) {
+            node = node->left;
+        } else if (k == left + 1) {
+            return node;
+        } else {
+            k -= left + 1;
+            node = node->right;
+        }
+    }
+    return NULL;
+#else
+    struct rbt_iterator it;
+    rbt_iter_seek(&it, node, INT_MIN);
+    while ((node = rbt_iter_next(&it)) != NULL && k > 1)
+        k--;
+    return node;
+#endif
+}
+
+/**
+ * Get the black height of a RBT: black nodes on a path from the root to a leaf
+ * @param node RBT root
+ * @return black height, 0 for an empty RBT
+ */
+static int black_height(struct rbt_node *node)
+{
+    int bh = 0;
+    for (; node != T_Nil; node = node->left) {
+        if (node->color == BLACK)
+            bh++;
+    }
+    return bh;
+}
+
+/**
+ * Join two RBTs of known black heights with a node between them
+ * in O(|black height difference| + 1)
+ * Red roots are made black first. The node goes down the right spine of the
+ * left tree (left spine of the right tree), if it is higher, to the first
+ * black node of the black height of the other tree, takes its place as a red
+ * node with the other tree as a child, and red nodes are fixed up.
+ * @param left RBT whose keys are not greater than the key of node, its parent is ignored
+ * @param left_bh black height of left
+ * @param node node to link, its links and color are overwritten
+ * @param right RBT whose keys are not less than the key of node, its parent is ignored
+ * @param right_bh black height of right
+ * @param bh black height of the joined RBT
+ * @return RBT with the nodes of left, node and right
+ */
+static struct rbt_node* rbt_join_bh(struct rbt_node *left, int left_bh, struct rbt_node *node,
+                                    struct rbt_node *right, int right_bh, int *bh)
+{
+    if (left != T_Nil) {
+        left->parent = T_Nil;
+        if (left->color == RED) {
+            left->color = BLACK;
+            left_bh++;
+        }
+    }
+    if (right != T_Nil) {
+        right->parent = T_Nil;
+        if (right->color == RED) {
+            right->color = BLACK;
+            right_bh++;
+        }
+    }
+
+    if (left_bh == right_bh) {
+        // node is the new black root
+        node->parent = T_Nil;
+        node->left = left;
+        node->right = right;
+        node->color = BLACK;
+        if (left != T_Nil)
+            left->parent = node;
+        if (right != T_Nil)
+            right->parent = node;
+        update_size(node);
+        *bh = left_bh + 1;
+        return node;
+    }
+
+    struct rbt_node *root;
+    struct rbt_node *parent = T_Nil;
+    struct rbt_node *y;
+    if (left_bh > right_bh) {
+        root = left;
+        y = left;
+        *bh = left_bh;
+        // black nodes on the path from y (included) to a leaf
+        int y_bh = left_bh;
+        while (y->color == RED || y_bh > right_bh) {
+            if (y->color == BLACK)
+                y_bh--;
+            parent = y;
+            y = y->right;
+        }
+        parent->right = node;
+        node->left = y;
+        node->right = right;
+    } else {
+        root = right;
+        y = right;
+        *bh = right_bh;
+        int y_bh = right_bh;
+        while (y->color == RED || y_bh > left_bh) {
+            if (y->color == BLACK)
+                y_bh--;
+            parent = y;
+            y = y->left;
+        }
+        parent->left = node;
+        node->left = left;
+        node->right = y;
+    }
+    node->parent = parent;
+    node->color = RED;
+    if (node->left != T_Nil)
+        node->left->parent = node;
+    if (node->right != T_Nil)
+        node->right->parent = node;
+    // sizes change from node up to the root
+    for (struct rbt_node *p = node; p != T_Nil; p = p->parent)
+        update_size(p);
+
+    root = fixup_red(root, node);
+    if (root->color == RED) {
+        // red nodes went up to the root: one more black level
+        root->color = BLACK;
+        (*bh)++;
+    }
+    return root;
+}
+
+/**
+ * Join two RBTs with a node between them in O(log n)
+ * @param left RBT whose keys are not greater than the key of node
+ * @param node node to link, its links and color are overwritten
+ * @param right RBT whose keys are not less than the key of node
+ * @return RBT with the nodes of left, node and right
+ */
+struct rbt_node* rbt_join(struct rbt_node *left, struct rbt_node *node, struct rbt_node *right)
+{
+    int bh;
+    return rbt_join_bh(left, black_height(left), node, right, black_height(right), &bh);
+}
+
+/**
+ * Split a RBT at a key in O(log n)
+ * Nodes on the path of key are joined, from the bottom up, with their
+ * subtree on the other side of the path into the tree of their side.
+ * Black heights are known on the way up, so each join costs the difference
+ * of black heights of the trees it links.
+ * @param node RBT root, its nodes are moved to the two trees
+ * @param key first key of the greater tree
+ * @param less RBT with the keys less than key
+ * @param greater RBT with the keys not less than key
+ */
+void rbt_split(struct rbt_node *node, int key, struct rbt_node **less, struct rbt_node **greater)
+{
+    int less_bh = 0;
+    int greater_bh = 0;
+
+    *less = T_Nil;
+    *greater = T_Nil;
+    if (node == T_Nil)
+        return;
+
+    // go down to the last node on the path of key
+    struct rbt_node *x = node;
+    for (;;) {
+        struct rbt_node *next = (x->key < key) ? x->right : x->left;
+        if (next == T_Nil)
+            break;
+        x = next;
+    }
+    // one child of x is a leaf
+    int x_bh = (x->color == BLACK);
+    for (;;) {
+        // read links and colors above x before x is joined
+        struct rbt_node *parent = x->parent;
+        int child_bh = x_bh - (x->color == BLACK);
+        if (x->key < key)
+            *less = rbt_join_bh(x->left, child_bh, x, *less, less_bh, &less_bh);
+        else
+            *greater = rbt_join_bh(*greater, greater_bh, x, x->right, child_bh, &greater_bh);
+        if (x == node)
+            break;
+        x_bh += (parent->color == BLACK);
+        x = parent;
+    }
+}
+
+/**
+ * Concatenate two RBTs in O(log n)
+ * The leftmost node of right is unlinked, then it joins the two trees.
+ * @param left RBT whose keys are not greater than the keys of right
+ * @param right RBT
+ * @return RBT with the nodes of left and right
+ */
+struct rbt_node* rbt_concat(struct rbt_node *left, struct rbt_node *right)
+{
+    if (right == T_Nil)
+        return left;
+    struct rbt_node *first = right;
+    while (first->left != T_Nil)
+        first = first->left;
+    right->parent = T_Nil;
+    right = rbt_remove(right, first);
+    return rbt_join(left, first, right);
+}
+
+/**
+ * Count the nodes of a RBT, stopping at limit
+ * @param node RBT root
+ * @param limit nodes to count at most
+ * @return number of nodes, limit if there are more
+ */
+static int rbt_count(struct rbt_node* node, int limit)
+{
+#ifdef SUBTREE_SIZE
+    return (node->size < limit) ? node->size : limit;
+#else
+    int n = 0;
+
+    if (node == T_Nil)
+        return 0;
+    while (node->left != T_Nil)
+        node = node->left;
+    while (node != T_Nil && n < limit) {
+        n++;
+        if (node->right != T_Nil) {
+            // successor is the leftmost node of right subtree
+            node = node->right;
+            while (node->left != T_Nil)
+                node = node->left;
+        } else {
+            // successor is the first ancestor reached from its left subtree
+            struct rbt_node *child;
+            do {
+                child = node;
+                node = node->parent;
+            } while (node != T_Nil && child == node->right);
+        }
+    }
+    return n;
+#endif
+}
+
+/**
+ * Merge sorted pairs into a RBT through joins, in O(m log(n / m + 1))
+ * The root splits the pairs: smaller keys are merged into its left subtree,
+ * greater or equal ones into its right subtree, then the root joins them again.
+ * Subtrees that get no pairs are not visited, pairs that reach an empty
+ * subtree are built into a balanced one around their middle pair.
+ * Black heights are known on the way down, so each join costs the
+ * difference of black heights of the trees it links.
+ * Recursion is as deep as the tree.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node RBT root
+ * @param node_bh black height of node
+ * @param pairs pairs sorted by key
+ * @param low first pair to merge
+ * @param high end of the pairs to merge, excluded
+ * @param bh black height of the merged RBT
+ * @return RBT with new nodes
+ */
+static struct rbt_node* rbt_merge(struct arena *arena, struct rbt_node *node, int node_bh,
+                                  const struct pairs *pairs, int low, int high, int *bh)
+{
+    if (low == high) {
+        *bh = node_bh;
+        return node;
+    }
+    int less;
+    int greater;
+    int child_bh;
+    if (node == T_Nil) {
+        less = low + (high - low) / 2;
+        node = rbt_create(arena, pairs->keys[less], pairs_data(pairs, less));
+        node->left = T_Nil;
+        node->right = T_Nil;
+        child_bh = 0;
+        greater = less + 1;
+    } else {
+        // equal keys are kept, new ones after
+        less = batch_lower_bound(pairs->keys, low, high, node->key);
+        child_bh = node_bh - (node->color == BLACK);
+        greater = less;
+    }
+
+    int left_bh;
+    int right_bh;
+    struct rbt_node *left = rbt_merge(arena, node->left, child_bh, pairs, low, less, &left_bh);
+    struct rbt_node *right = rbt_merge(arena, node->right, child_bh, pairs, greater, high, &right_bh);
+    return rbt_join_bh(left, left_bh, node, right, right_bh, bh);
+}
+
+/**
+ * Insert a batch of pairs in a RBT
+ * A big enough batch is sorted by key and merged with the tree by rbt_merge,
+ * a smaller one is inserted in arrival order, as one by one.
+ * @param arena arena to allocate nodes from, NULL to use malloc
+ * @param node RBT root
+ * @param pairs pairs to insert, sorted in place when merged
+ * @return RBT with new nodes
+ */
+struct rbt_node* rbt_insert_batch(struct arena *arena, struct rbt_node *node, struct pairs *pairs)
+{
+    int limit = batch_merge_limit(pairs->count);
+    if (limit > 0 && batch_merges(pairs->count, rbt_count(node, limit))) {
+        int bh;
+        pairs_sort(pairs);
+        return rbt_merge(arena, node, black_height(node), pairs, 0, pairs->count, &bh);
+    }
+
+    for (int i = 0; i < pairs->count; i++)
+        node = rbt_insert(arena, node, pairs->keys[i], pairs_data(pairs, i));
+    return node;
+}
@@ -0,0 +1,205 @@
+//
+// Buffered command reader
+//
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "reader.h"
+
+/**
+ * Check if a character separates tokens
+ * @param c character
+ * @return 1 if c is a blank
+ */
+static inline int is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Initialize a reader on a file descriptor
+ * @param reader reader to initialize
+ * @param fd file descriptor to read from
+ */
+void reader_init(struct reader *reader, int fd)
+{
+    reader->fd = fd;
+    reader->buffer = (char *) malloc(READER_BUFFER_SIZE + 1);
+    if (reader->buffer == NULL)
+    {
+        fprintf (stderr, "create reader buffer fail\n");
+        exit(1);
+    }
+    reader->pos = reader->buffer;
+    reader->end = reader->buffer;
+    reader->eof = 0;
+}
+
+/**
+ * Read more bytes into the buffer
+ * The unparsed tail (an incomplete line) is moved to the start of the buffer.
+ * @param reader reader to fill
+ * @return 0 if the buffer is full or the file is over
+ */
+static int reader_fill(struct reader *reader)
+{
+    size_t left = reader->end - reader->pos;
+    if (reader->pos != reader->buffer) {
+        memmove(reader->buffer, reader->pos, left);
+        reader->pos = reader->buffer;
+        reader->end = reader->buffer + left;
+    }
+    if (left == READER_BUFFER_SIZE)
+        return 0;
+
+    ssize_t count;
+    do {
+        count = read(reader->fd, reader->end, READER_BUFFER_SIZE - left);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+        reader->eof = 1;
+        return 0;
+    }
+    reader->end += count;
+    return 1;
+}
+
+/**
+ * Get next non blank line of the reader, terminated in place
+ * A line longer than READER_BUFFER_SIZE is split.
+ * @param reader reader to read from
+ * @return first character of the line, NULL when there are no more lines
+ */
+static char* reader_line(struct reader *reader)
+{
+    char *eol;
+    // Find a complete, non blank line in the buffer
+    for (;;) {
+        while (reader->pos < reader->end && (is_blank(*reader->pos) || *reader->pos == '\n'))
+            reader->pos++;
+        if (reader->pos < reader->end) {
+            eol = (char *) memchr(reader->pos, '\n', reader->end - reader->pos);
+            if (eol != NULL)
+                break;
+        }
+        if (!reader_fill(reader)) {
+            if (reader->pos == reader->end)
+                return NULL;
+            // last line without newline, or line filling the whole buffer
+            eol = reader->end;
+            break;
+        }
+    }
+
+    char *line = reader->pos;
+    *eol = '\0';
+    reader->pos = (eol < reader->end) ? eol + 1 : eol;
+    return line;
+}
+
+/**
+ * Parse an optional integer key
+ * A token that is not a whole number, e.g. the file name 123.txt, is no key:
+ * it is left to parse_data.
+ * @param p position in the line
+ * @param key parsed key, 0 if missing
+ * @return position after the key, at the token if there is no key
+ */
+static char* parse_key(char *p, int *key)
+{
+    while (is_blank(*p))
+        p++;
+    char *q = p;
+    int negative = 0;
+    if (*q == '-' || *q == '+') {
+        negative = (*q == '-');
+        q++;
+    }
+    char *digits = q;
+    unsigned int value = 0;
+    while (*q >= '0' && *q <= '9') {
+        value = value * 10 + (unsigned int) (*q - '0');
+        q++;
+    }
+    if (q == digits || (*q != '\0' && !is_blank(*q))) {
+        *key = 0;
+        return p;
+    }
+    *key = negative ? (int) (0u - value) : (int) value;
+    return q;
+}
+
+/**
+ * Parse an optional data word, terminated in place
+ * @param p position in the line
+ * @param data parsed word, empty string if missing
+ */
+static void parse_data(char *p, char **data)
+{
+    while (is_blank(*p))
+        p++;
+    *data = p;
+    while (*p != '\0' && !is_blank(*p))
+        p++;
+    *p = '\0';
+}
+
+/**
+ * Extract command, key and data from next command line.
+ * Same rules of scanLine: the command is the first word, then an
+ * optional integer key and an optional data word. Missing key is 0,
+ * missing data is an empty string. Blank lines are skipped.
+ * A line longer than READER_BUFFER_SIZE is split.
+ * @param reader reader to read from
+ * @param cmd command to execute
+ * @param key key to use
+ * @param data data to insert in key
+ * @return 0 when there are no more commands
+ */
+int reader_next(struct reader *reader, char **cmd, int *key, char **data)
+{
+    char *p = reader_line(reader);
+    if (p == NULL)
+        return 0;
+
+    // command
+    *cmd = p;
+    while (*p != '\0' && !is_blank(*p))
+        p++;
+    if (*p != '\0')
+        *p++ = '\0';
+
+    p = parse_key(p, key);
+    parse_data(p, data);
+    return 1;
+}
+
+/**
+ * Extract key and data from next line, as the arguments of an insert command
+ * @param reader reader to read from
+ * @param key key of the line
+ * @param data data of the line
+ * @return 0 when there are no more lines
+ */
+int reader_next_pair(struct reader *reader, int *key, char **data)
+{
+    char *p = reader_line(reader);
+    if (p == NULL)
+        return 0;
+
+    p = parse_key(p, key);
+    parse_data(p, data);
+    return 1;
+}
+
+/**
+ * Free the buffer of a reader
+ * @param reader reader to free
+ */
+void reader_free(struct reader *reader)
+{
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
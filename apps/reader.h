@@ -0,0 +1,30 @@
+//
+// Buffered command reader
+//
+#ifndef READER_H
+#define READER_H
+
+#include <stddef.h>
+
+#define READER_BUFFER_SIZE 1048576   // bytes read from the file descriptor at once
+
+/**
+ * Structure to represent a buffered reader
+ * Lines are parsed in place: the returned tokens point inside buffer
+ * and stay valid until the next call to reader_next or reader_next_pair.
+ */
+struct reader
+{
+    int fd;         // file descriptor to read from
+    char *buffer;   // READER_BUFFER_SIZE bytes plus one for a terminator
+    char *pos;      // first byte not yet parsed
+    char *end;      // end of the bytes read
+    int eof;        // no more bytes to read
+};
+
+void reader_init(struct reader *reader, int fd);
+int reader_next(struct reader *reader, char **cmd, int *key, char **data);
+int reader_next_pair(struct reader *reader, int *key, char **data);
+void reader_free(struct reader *reader);
+
+#endif //READER_H
@@ -0,0 +1,115 @@
+//
+// Reader-writer tree: a BST, AVL or RBT behind one pthread read-write lock
+//
+#define _GNU_SOURCE     // pthread_rwlockattr_setkind_np, writer preference of glibc
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rw_tree.h"
+
+/**
+ * Initialize an empty tree and its lock
+ * Writer preference needs glibc, elsewhere the default policy of the system is used.
+ * @param tree tree to initialize
+ * @param kind tree behind the lock
+ * @param policy who gets the lock first
+ */
+void rw_tree_init(struct rw_tree *tree, enum rwTree kind, enum rwPolicy policy)
+{
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__)
+    if (policy == RW_PREFER_WRITERS)
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    if (pthread_rwlock_init(&tree->lock, &attr) != 0)
+    {
+        fprintf (stderr, "create rw tree fail\n");
+        exit(1);
+    }
+    pthread_rwlockattr_destroy(&attr);
+    tree->tree = kind;
+    tree->policy = policy;
+    arena_init(&tree->arena, ARENA_SLAB_SIZE);
+    tree->bst = NULL;
+    tree->avl = NULL;
+    tree->rbt = T_Nil;
+}
+
+/**
+ * Insert a key in a tree
+ * @param tree shared tree
+ * @param key key to insert
+ * @param data data to insert, copied
+ */
+void rw_tree_insert(struct rw_tree *tree, int key, const char *data)
+{
+    pthread_rwlock_wrlock(&tree->lock);
+    // trees copy data in their payload, they do not change it
+    if (tree->tree == RW_BST)
+        tree->bst = bst_insert(&tree->arena, tree->bst, key, (char *) data);
+    else if (tree->tree == RW_AVL)
+        tree->avl = avl_insert(&tree->arena, tree->avl, key, (char *) data);
+    else
+        tree->rbt = rbt_insert(&tree->arena, tree->rbt, key, (char *) data);
+    pthread_rwlock_unlock(&tree->lock);
+}
+
+/**
+ * Search a key in a tree and, if found, copy its data
+ * Data is copied under the read lock: a pointer into the
+ * node could be freed by a delete as soon as the lock is released.
+ * @param tree shared tree
+ * @param key key to search
+ * @param data buffer for the data, NULL not to copy it
+ * @param size size of the buffer, data is truncated to fit
+ * @return 1 if key exist, 0 otherwise
+ */
+int rw_tree_find(struct rw_tree *tree, int key, char *data, size_t size)
+{
+    const char *found;
+    pthread_rwlock_rdlock(&tree->lock);
+    if (tree->tree == RW_BST)
+        found = bst_find(tree->bst, key);
+    else if (tree->tree == RW_AVL)
+        found = avl_find(tree->avl, key);
+    else
+        found = rbt_find(tree->rbt, key);
+    if (found != NULL && data != NULL && size > 0) {
+        strncpy(data, found, size - 1);
+        data[size - 1] = '\0';
+    }
+    pthread_rwlock_unlock(&tree->lock);
+    return found != NULL;
+}
+
+/**
+ * Delete a key from a tree
+ * @param tree shared tree
+ * @param key key to delete
+ */
+void rw_tree_delete(struct rw_tree *tree, int key)
+{
+    pthread_rwlock_wrlock(&tree->lock);
+    if (tree->tree == RW_BST) {
+        tree->bst = bst_delete(&tree->arena, tree->bst, key);
+    } else if (tree->tree == RW_AVL) {
+        tree->avl = avl_delete(&tree->arena, tree->avl, key);
+    } else {
+        tree->rbt = rbt_delete(&tree->arena, tree->rbt, key);
+    }
+    pthread_rwlock_unlock(&tree->lock);
+}
+
+/**
+ * Free a tree and its lock, no thread may use it any more
+ * @param tree shared tree
+ */
+void rw_tree_free(struct rw_tree *tree)
+{
+    arena_free(&tree->arena);
+    pthread_rwlock_destroy(&tree->lock);
+    tree->bst = NULL;
+    tree->avl = NULL;
+    tree->rbt = T_Nil;
+}
@@ -0,0 +1,52 @@
+//
+// Reader-writer tree: a BST, AVL or RBT behind one pthread read-write lock
+//
+#ifndef RW_TREE_H
+#define RW_TREE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "trees.h"
+
+/**
+ * Enum to represent the tree
+ * behind the lock
+ */
+enum rwTree {
+    RW_BST,
+    RW_AVL,
+    RW_RBT
+};
+
+/**
+ * Enum to represent who gets the lock
+ * first when readers and writers wait
+ */
+enum rwPolicy {
+    RW_PREFER_READERS,  // default of pthread_rwlock_t: new readers may pass waiting writers
+    RW_PREFER_WRITERS   // new readers wait behind waiting writers, writers cannot starve
+};
+
+/**
+ * Structure to represent a tree shared by threads
+ * Finds run in parallel under the read lock, inserts and deletes
+ * take the write lock.
+ */
+struct rw_tree
+{
+    pthread_rwlock_t lock;
+    enum rwTree tree;
+    enum rwPolicy policy;
+    struct arena arena;
+    struct bst_node *bst;
+    struct avl_node *avl;
+    struct rbt_node *rbt;
+};
+
+void rw_tree_init(struct rw_tree *tree, enum rwTree kind, enum rwPolicy policy);
+void rw_tree_insert(struct rw_tree *tree, int key, const char *data);
+int rw_tree_find(struct rw_tree *tree, int key, char *data, size_t size);
+void rw_tree_delete(struct rw_tree *tree, int key);
+void rw_tree_free(struct rw_tree *tree);
+
+#endif //RW_TREE_H
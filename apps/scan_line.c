@@ -0,0 +1,48 @@
+//
+// Command line input
+//
+#include <stdio.h>
+#include <string.h>
+#include "trees.h"
+
+/**
+ * Extract command, key and data from command line.
+ * @param cmd command to execute
+ * @param key key to use
+ * @param data data to insert in key
+ */
+void scanLine(char *cmd, int *key, char *data) {
+    // scan line of text
+    char line[MAX_LINE_SIZE];
+    /*
+     * You can instruct the scanf to ignore the special characters
+     * by prefixing % by a space character.
+     */
+    scanf(" %[^\n]s", line);
+
+    char *tmp_cmd=strtok(line, " ");
+
+    /*
+     * strcpy doesn't allocate memory for you.
+     * you need to have the destination of strcpy be already
+     * allocated memory locations
+    */
+    strcpy(cmd, tmp_cmd);
+
+    char *param = strtok(NULL, "\n");
+
+    char tmp_data[MAX_LINE_SIZE];
+    strcpy(tmp_data, "");
+    // A null pointer is returned if there are no tokens left to retrieve.
+    if  (param != NULL) {
+        sscanf(param, "%d%s", key, tmp_data);
+        if ((strcmp(tmp_data, "") == 0)) {
+            strcpy(data, "");
+        } else {
+            strcpy(data, tmp_data);
+        }
+    } else {
+        strcpy(data, "");
+        *key = 0;
+    }
+}
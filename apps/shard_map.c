@@ -0,0 +1,171 @@
+//
+// Sharded map: keys partitioned into AVL or RBT shards, each one with its own lock
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "shard_map.h"
+
+/**
+ * Initialize a map of empty shards
+ * @param map map to initialize
+ * @param count number of shards
+ * @param tree tree of the shards
+ * @param partition how keys are spread over the shards
+ */
+void shard_map_init(struct shard_map *map, int count, enum shardTree tree, enum shardPartition partition)
+{
+    void *shards;
+    if (count < 1 || posix_memalign(&shards, SHARD_ALIGN, count * sizeof(struct shard)) != 0)
+    {
+        fprintf (stderr, "create shard map fail\n");
+        exit(1);
+    }
+    map->tree = tree;
+    map->partition = partition;
+    map->count = count;
+    map->shards = (struct shard *) shards;
+    for (int i = 0; i < count; i++) {
+        pthread_mutex_init(&map->shards[i].lock, NULL);
+        arena_init(&map->shards[i].arena, ARENA_SLAB_SIZE);
+        map->shards[i].avl = NULL;
+        map->shards[i].rbt = T_Nil;
+    }
+}
+
+/**
+ * Get the shard of a key
+ * @param map sharded map
+ * @param key key
+ * @return shard holding key
+ */
+static struct shard* shard_of(const struct shard_map *map, int key)
+{
+    uint32_t slot;
+    if (map->partition == SHARD_HASH)
+        slot = (uint32_t) key * 2654435761u;    // Knuth multiplicative hash
+    else
+        slot = (uint32_t) key ^ 0x80000000u;    // INT_MIN is slot 0, order is kept
+    // scale the 32-bit slot to a shard, no division
+    return &map->shards[((uint64_t) slot * (uint64_t) map->count) >> 32];
+}
+
+/**
+ * Search a key in a shard, the shard is locked
+ * @param map sharded map
+ * @param shard shard of key
+ * @param key key to search
+ * @return key data if key exist, NULL otherwise
+ */
+static const char* shard_find(const struct shard_map *map, struct shard *shard, int key)
+{
+    if (map->tree == SHARD_AVL)
+        return avl_find(shard->avl, key);
+    return rbt_find(shard->rbt, key);
+}
+
+/**
+ * Insert a key in a shard, the shard is locked
+ * @param map sharded map
+ * @param shard shard of key
+ * @param key key to insert
+ * @param data data to insert, copied
+ */
+static void shard_insert(const struct shard_map *map, struct shard *shard, int key, const char *data)
+{
+    // trees copy data in their payload, they do not change it
+    if (map->tree == SHARD_AVL)
+        shard->avl = avl_insert(&shard->arena, shard->avl, key, (char *) data);
+    else
+        shard->rbt = rbt_insert(&shard->arena, shard->rbt, key, (char *) data);
+}
+
+/**
+ * Insert a key in a map
+ * @param map sharded map
+ * @param key key to insert
+ * @param data data to insert, copied
+ */
+void shard_map_insert(struct shard_map *map, int key, const char *data)
+{
+    struct shard *shard = shard_of(map, key);
+    pthread_mutex_lock(&shard->lock);
+    shard_insert(map, shard, key, data);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * Search a key in a map and insert it if missing, as one operation
+ * @param map sharded map
+ * @param key key to search and insert
+ * @param data data to insert, copied
+ * @return 1 if key was inserted, 0 if it was found
+ */
+int shard_map_search_and_insert(struct shard_map *map, int key, const char *data)
+{
+    struct shard *shard = shard_of(map, key);
+    int inserted = 0;
+    pthread_mutex_lock(&shard->lock);
+    if (shard_find(map, shard, key) == NULL) {
+        shard_insert(map, shard, key, data);
+        inserted = 1;
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return inserted;
+}
+
+/**
+ * Search a key in a map and, if found, copy its data
+ * Data is copied while the shard is locked: a pointer into the
+ * node could be freed by a delete as soon as the lock is released.
+ * @param map sharded map
+ * @param key key to search
+ * @param data buffer for the data, NULL not to copy it
+ * @param size size of the buffer, data is truncated to fit
+ * @return 1 if key exist, 0 otherwise
+ */
+int shard_map_find(struct shard_map *map, int key, char *data, size_t size)
+{
+    struct shard *shard = shard_of(map, key);
+    pthread_mutex_lock(&shard->lock);
+    const char *found = shard_find(map, shard, key);
+    if (found != NULL && data != NULL && size > 0) {
+        strncpy(data, found, size - 1);
+        data[size - 1] = '\0';
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return found != NULL;
+}
+
+/**
+ * Delete a key from a map
+ * @param map sharded map
+ * @param key key to delete
+ */
+void shard_map_delete(struct shard_map *map, int key)
+{
+    struct shard *shard = shard_of(map, key);
+    pthread_mutex_lock(&shard->lock);
+    if (map->tree == SHARD_AVL) {
+        shard->avl = avl_delete(&shard->arena, shard->avl, key);
+    } else {
+        shard->rbt = rbt_delete(&shard->arena, shard->rbt, key);
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * Free all shards of a map, no thread may use it any more
+ * @param map sharded map
+ */
+void shard_map_free(struct shard_map *map)
+{
+    for (int i = 0; i < map->count; i++) {
+        arena_free(&map->shards[i].arena);
+        pthread_mutex_destroy(&map->shards[i].lock);
+    }
+    free(map->shards);
+    map->shards = NULL;
+    map->count = 0;
+}
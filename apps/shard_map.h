@@ -0,0 +1,67 @@
+//
+// Sharded map: keys partitioned into AVL or RBT shards, each one with its own lock
+//
+#ifndef SHARD_MAP_H
+#define SHARD_MAP_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "trees.h"
+
+#define SHARD_ALIGN 64   // shards start on their own cache line, so their locks do not share one
+
+#if defined(__GNUC__)
+#define SHARD_ALIGNED __attribute__((aligned(SHARD_ALIGN)))
+#else
+#define SHARD_ALIGNED
+#endif
+
+/**
+ * Enum to represent the tree
+ * of every shard of a map
+ */
+enum shardTree {
+    SHARD_AVL,
+    SHARD_RBT
+};
+
+/**
+ * Enum to represent how keys
+ * are spread over the shards
+ */
+enum shardPartition {
+    SHARD_RANGE,   // shard i holds the i-th slice of keys INT_MIN to INT_MAX
+    SHARD_HASH     // shard of a key is chosen by a multiplicative hash
+};
+
+/**
+ * Structure to represent a shard: a tree, the arena of its nodes and its lock
+ */
+struct shard
+{
+    pthread_mutex_t lock;
+    struct arena arena;
+    struct avl_node *avl;
+    struct rbt_node *rbt;
+} SHARD_ALIGNED;
+
+/**
+ * Structure to represent a sharded map
+ * Operations on keys of different shards run in parallel.
+ */
+struct shard_map
+{
+    enum shardTree tree;
+    enum shardPartition partition;
+    int count;              // number of shards
+    struct shard *shards;
+};
+
+void shard_map_init(struct shard_map *map, int count, enum shardTree tree, enum shardPartition partition);
+void shard_map_insert(struct shard_map *map, int key, const char *data);
+int shard_map_search_and_insert(struct shard_map *map, int key, const char *data);
+int shard_map_find(struct shard_map *map, int key, char *data, size_t size);
+void shard_map_delete(struct shard_map *map, int key);
+void shard_map_free(struct shard_map *map);
+
+#endif //SHARD_MAP_H
@@ -0,0 +1,389 @@
+//
+// Binary trees library: BST, AVL, Red-Black Tree and B-tree
+//
+#ifndef TREES_H
+#define TREES_H
+
+#include <stdint.h>
+#include <limits.h>
+#include "arena.h"
+#include "payload.h"
+#include "reader.h"
+#include "output.h"
+#include "pairs.h"
+
+#define MAX_LINE_SIZE 1000   // maximum size of a line of input
+#define MAX_CMD_LENGTH 15    // maximum length of a command name
+#define AVL_MAX_HEIGHT 64    // no AVL with less than 2^44 nodes is taller
+#define BTREE_MIN_DEGREE 8   // B-tree nodes but the root hold 7 to 15 keys
+#define BTREE_MAX_KEYS (2 * BTREE_MIN_DEGREE - 1)
+#define BTREE_MAX_HEIGHT 16  // no B-tree with less than 2^49 keys is taller
+#define BATCH_MAX_SIZE 65536 // binsert commands inserted at once, at most
+
+/*************************
+ *  Input
+ *************************/
+
+void scanLine(char *cmd, int *key, char *data);
+
+
+/*************************
+ *  Implicit trees
+ *************************/
+
+/**
+ * Get first slot in order of an implicit tree: its leftmost slot
+ * Slots are numbered breadth first from 1, children of slot k are 2k and 2k + 1.
+ * @param size number of slots
+ * @return leftmost slot
+ */
+static inline int implicit_first(int size)
+{
+    int k = 1;
+    while (2 * k <= size)
+        k = 2 * k;
+    return k;
+}
+
+/**
+ * Get next slot in order of an implicit tree
+ * @param k current slot
+ * @param size number of slots
+ * @return slot after k, 0 after the last slot
+ */
+static inline int implicit_next(int k, int size)
+{
+    if (2 * k + 1 <= size) {
+        // leftmost slot of right subtree
+        k = 2 * k + 1;
+        while (2 * k <= size)
+            k = 2 * k;
+    } else {
+        // up while k is a right child, then up once more
+        while (k & 1)
+            k >>= 1;
+        k >>= 1;
+    }
+    return k;
+}
+
+
+/*************************
+ *  Batch insert
+ *************************/
+
+// Smallest tree plus batch worth a merge: smaller trees stay in cache, where
+// inserting key by key is as fast as merging
+#define BATCH_MERGE_SIZE 131072
+
+/**
+ * Get the smallest tree a batch is better inserted in key by key than merged with
+ * Merging a batch of m keys through joins costs O(m log(n / m + 1)), but it only
+ * beats m inserts in a tree of n nodes once m >= n / 4 and the tree outgrows the
+ * cache: the batch benchmark breaks even around n / 8 for the RBT.
+ * @param count number of keys in the batch
+ * @return number of nodes, 0 if the batch is too small to be ever merged
+ */
+static inline int batch_merge_limit(int count)
+{
+    if (5L * count < BATCH_MERGE_SIZE)
+        return 0;
+    return count > (INT_MAX - 1) / 4 ? INT_MAX : 4 * count + 1;
+}
+
+/**
+ * Tell whether a batch is merged with a tree or inserted in key by key
+ * @param count number of keys in the batch
+ * @param nodes number of nodes in the tree, counted up to batch_merge_limit(count)
+ * @return 1 if the batch is merged, 0 otherwise
+ */
+static inline int batch_merges(int count, int nodes)
+{
+    return nodes < batch_merge_limit(count) && (long) nodes + count >= BATCH_MERGE_SIZE;
+}
+
+/**
+ * Find the first of sorted keys not less than key, by binary search
+ * @param keys keys sorted in increasing order
+ * @param low first key to search
+ * @param high end of the keys to search, excluded
+ * @param key key to find
+ * @return position of the first key not less than key, high if there is none
+ */
+static inline int batch_lower_bound(const int *keys, int low, int high, int key)
+{
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (keys[middle] < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+
+/*************************
+ *  BST
+ *************************/
+
+/**
+ * Structure to represent each
+ * node in a binary search tree
+ */
+typedef struct bst_node
+{
+    int key;
+    struct payload data;
+    struct bst_node *left;
+    struct bst_node *right;
+} bst_node;
+
+struct bst_node* bst_create(struct arena *arena, int key, char *data);
+struct bst_node* bst_insert(struct arena *arena, struct bst_node *node, int key, char *data);
+const char* bst_find(struct bst_node* node, int key);
+struct bst_node* bst_delete(struct arena *arena, struct bst_node *node, int key);
+void bst_free_nodes(struct bst_node* node);
+void bst_clear(struct arena *arena, struct bst_node* node);
+void bst_show(struct bst_node* node);
+int bst_in_order(struct bst_node* node, struct bst_node **nodes);
+struct bst_node* bst_build(struct bst_node **nodes, int n);
+struct bst_node* bst_load(struct arena *arena, struct bst_node *node, const struct pairs *pairs);
+struct bst_node* bst_insert_batch(struct arena *arena, struct bst_node *node, struct pairs *pairs);
+
+/**
+ * Structure to represent an in order cursor on a BST
+ * The stack holds the nodes still to visit whose right subtree is not
+ * visited yet, it grows with the height of the tree.
+ */
+struct bst_iterator
+{
+    struct bst_node **stack;
+    int depth;
+    int capacity;
+};
+
+void bst_iter_init(struct bst_iterator *it);
+void bst_iter_seek(struct bst_iterator *it, struct bst_node *root, int key);
+struct bst_node* bst_iter_next(struct bst_iterator *it);
+void bst_iter_free(struct bst_iterator *it);
+
+
+/*************************
+ *  AVL
+ *************************/
+
+/**
+ * Structure to represent each
+ * node in an AVL binary search tree
+ */
+typedef struct avl_node
+{
+    int key;
+    struct payload data;
+    int height;
+#ifdef SUBTREE_SIZE
+    int size;   // number of nodes of the subtree, for rank and select
+#endif
+    struct avl_node *left;
+    struct avl_node *right;
+} avl_node;
+
+struct avl_node* avl_right_rotate(struct avl_node* root);
+struct avl_node* avl_left_rotate(struct avl_node* root);
+struct avl_node* avl_create(struct arena *arena, int key, char *data);
+struct avl_node* avl_insert(struct arena *arena, struct avl_node *node, int key, char *data);
+const char* avl_find(struct avl_node* node, int key);
+struct avl_node* avl_delete(struct arena *arena, struct avl_node *node, int key);
+void avl_free_nodes(struct avl_node* node);
+void avl_clear(struct arena *arena, struct avl_node* node);
+void avl_show(struct avl_node* node);
+int avl_in_order(struct avl_node* node, struct avl_node **nodes);
+struct avl_node* avl_build(struct avl_node **nodes, int n);
+struct avl_node* avl_load(struct arena *arena, struct avl_node *node, const struct pairs *pairs);
+struct avl_node* avl_insert_batch(struct arena *arena, struct avl_node *node, struct pairs *pairs);
+
+/**
+ * Structure to represent an in order cursor on an AVL
+ * The stack holds the nodes still to visit whose right subtree is not
+ * visited yet, at most one per level.
+ */
+struct avl_iterator
+{
+    struct avl_node *stack[AVL_MAX_HEIGHT];
+    int depth;
+};
+
+void avl_iter_seek(struct avl_iterator *it, struct avl_node *root, int key);
+struct avl_node* avl_iter_next(struct avl_iterator *it);
+int avl_rank(struct avl_node* node, int key);
+struct avl_node* avl_select(struct avl_node* node, int k);
+struct avl_node* avl_join(struct avl_node *left, struct avl_node *node, struct avl_node *right);
+void avl_split(struct avl_node *node, int key, struct avl_node **less, struct avl_node **greater);
+struct avl_node* avl_concat(struct avl_node *left, struct avl_node *right);
+
+
+/*************************
+ *  RBT
+ *************************/
+
+/**
+ * Enum to represent each
+ * node color in a red-black tree
+ */
+enum nodeColor {
+    BLACK,
+    RED
+};
+
+/**
+ * Structure to represent each
+ * node in a red-black tree
+ */
+typedef struct rbt_node
+{
+    int key;
+    struct payload data;
+    enum nodeColor color;
+#ifdef SUBTREE_SIZE
+    int size;   // number of nodes of the subtree, for rank and select (0 in T_Nil)
+#endif
+    struct rbt_node *parent;
+    struct rbt_node *left;
+    struct rbt_node *right;
+} rbt_node;
+
+// Sentinel used as leaf and as parent of the root, an empty RBT is T_Nil
+// Shared by all RBTs, so that it is only read: RBTs in different threads need no common lock
+extern struct rbt_node *T_Nil;
+
+struct rbt_node* rbt_create(struct arena *arena, int key, char *data);
+struct rbt_node* rbt_left_rotate(rbt_node* root, rbt_node* x);
+struct rbt_node* rbt_right_rotate(rbt_node* root, rbt_node* y);
+struct rbt_node* rbt_insert(struct arena *arena, struct rbt_node *node, int key, char* data);
+const char* rbt_find(struct rbt_node* node, int key);
+struct rbt_node* rbt_delete(struct arena *arena, struct rbt_node *node, int key);
+void rbt_free_nodes(struct rbt_node* node);
+void rbt_clear(struct arena *arena, struct rbt_node* node);
+void rbt_show(struct rbt_node* node);
+int rbt_in_order(struct rbt_node* node, struct rbt_node **nodes);
+struct rbt_node* rbt_build(struct rbt_node **nodes, int n);
+struct rbt_node* rbt_load(struct arena *arena, struct rbt_node *node, const struct pairs *pairs);
+struct rbt_node* rbt_insert_batch(struct arena *arena, struct rbt_node *node, struct pairs *pairs);
+
+/**
+ * Structure to represent an in order cursor on a RBT
+ * Successors are found through parent pointers, no stack is needed.
+ */
+struct rbt_iterator
+{
+    struct rbt_node *node;  // next node to visit, T_Nil at the end
+};
+
+void rbt_iter_seek(struct rbt_iterator *it, struct rbt_node *root, int key);
+struct rbt_node* rbt_iter_next(struct rbt_iterator *it);
+int rbt_rank(struct rbt_node* node, int key);
+struct rbt_node* rbt_select(struct rbt_node* node, int k);
+struct rbt_node* rbt_join(struct rbt_node *left, struct rbt_node *node, struct rbt_node *right);
+void rbt_split(struct rbt_node *node, int key, struct rbt_node **less, struct rbt_node **greater);
+struct rbt_node* rbt_concat(struct rbt_node *left, struct rbt_node *right);
+
+
+/*************************
+ *  RBT, packed color
+ *************************/
+
+/**
+ * Structure to represent each node in a red-black tree
+ * whose color is the lowest bit of the parent pointer
+ * (nodes are aligned to 8 bytes, so that bit is always 0 in a pointer).
+ * Fields must be read and written through the rbtp_ accessors.
+ */
+typedef struct rbtp_node
+{
+    int key;
+    struct payload data;
+    uintptr_t parent_color;
+    struct rbtp_node *left;
+    struct rbtp_node *right;
+} rbtp_node;
+
+// Sentinel of packed RBTs, an empty packed RBT is TP_Nil
+extern struct rbtp_node *TP_Nil;
+
+/**
+ * Get the parent of a node
+ * @param node rbtp_node
+ * @return parent node
+ */
+static inline struct rbtp_node* rbtp_parent(const struct rbtp_node *node)
+{
+    return (struct rbtp_node *) (node->parent_color & ~(uintptr_t) 1);
+}
+
+/**
+ * Get the color of a node
+ * @param node rbtp_node
+ * @return node color
+ */
+static inline enum nodeColor rbtp_color(const struct rbtp_node *node)
+{
+    return (enum nodeColor) (node->parent_color & 1);
+}
+
+/**
+ * Set the parent of a node, keeping its color
+ * @param node rbtp_node
+ * @param parent new parent
+ */
+static inline void rbtp_set_parent(struct rbtp_node *node, struct rbtp_node *parent)
+{
+    node->parent_color = (uintptr_t) parent | (node->parent_color & 1);
+}
+
+/**
+ * Set the color of a node, keeping its parent
+ * @param node rbtp_node
+ * @param color new color
+ */
+static inline void rbtp_set_color(struct rbtp_node *node, enum nodeColor color)
+{
+    node->parent_color = (node->parent_color & ~(uintptr_t) 1) | (uintptr_t) color;
+}
+
+struct rbtp_node* rbtp_create(struct arena *arena, int key, char *data);
+struct rbtp_node* rbtp_left_rotate(rbtp_node* root, rbtp_node* x);
+struct rbtp_node* rbtp_right_rotate(rbtp_node* root, rbtp_node* y);
+struct rbtp_node* rbtp_insert(struct arena *arena, struct rbtp_node *node, int key, char* data);
+const char* rbtp_find(struct rbtp_node* node, int key);
+void rbtp_free_nodes(struct rbtp_node* node);
+void rbtp_clear(struct arena *arena, struct rbtp_node* node);
+
+
+/*************************
+ *  B-tree
+ *************************/
+
+/**
+ * Structure to represent each
+ * node in a B-tree of minimum degree BTREE_MIN_DEGREE
+ * Keys come first and fill exactly one 64 bytes cache line: the slots after
+ * the last key hold INT_MAX, so a node is searched with a few SIMD compares.
+ */
+typedef struct btree_node
+{
+    int keys[BTREE_MAX_KEYS + 1];
+    int count;  // number of keys
+    int leaf;   // 1 if the node has no children
+    struct payload data[BTREE_MAX_KEYS];
+    struct btree_node *child[BTREE_MAX_KEYS + 1];
+} btree_node;
+
+struct btree_node* btree_insert(struct arena *arena, struct btree_node *root, int key, char *data);
+const char* btree_find(struct btree_node* node, int key);
+struct btree_node* btree_delete(struct arena *arena, struct btree_node *root, int key);
+void btree_free_nodes(struct btree_node* node);
+void btree_clear(struct arena *arena, struct btree_node* node);
+void btree_show(struct btree_node* node);
+
+#endif //TREES_H
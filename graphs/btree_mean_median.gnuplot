@@ -0,0 +1,9 @@
+set xlabel 'Numero nodi'
+set ylabel 'Tempo (s)'
+set xrange [-20000:]
+set key right bottom
+set terminal pdf size 21cm,10cm enhanced color rounded \
+    font 'Helvetica,12'
+set output 'btree_mean_median.pdf'
+plot "output_mean.txt" using 1:8 with linespoints pt 5 ps 0.1 lw 1 lc "orchid" title "B-tree (mean)", "output_median.txt" using 1:8 with linespoints pt 5 ps 0.1 lw 1 lc "dark-violet" title "B-tree (median)"
+